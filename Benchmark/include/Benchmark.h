@@ -0,0 +1,38 @@
+/**
+ * @file   Benchmark.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  A simple timer for the benchmarks.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>                                                                                   // std::chrono::steady_clock
+
+namespace RobotLibrary { namespace Benchmark {
+
+/**
+ * Time a function by calling it many times.
+ * @param function The function to be timed. It takes no arguments.
+ * @param numberOfCalls How many times to call it.
+ * @return The average time for one call, in microseconds.
+ */
+template <class Function>
+inline double
+microseconds_per_call(Function &&function, const unsigned int &numberOfCalls)
+{
+     for(unsigned int i = 0; i < numberOfCalls/10 + 1; ++i) function();                           // Warm up the cache
+     
+     auto start = std::chrono::steady_clock::now();
+     
+     for(unsigned int i = 0; i < numberOfCalls; ++i) function();
+     
+     std::chrono::duration<double,std::micro> elapsed = std::chrono::steady_clock::now() - start;
+     
+     return elapsed.count()/numberOfCalls;
+}
+
+} }                                                                                                 // namespace RobotLibrary::Benchmark
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file   ModelBenchmark.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Times one control cycle of the kinematics and dynamics for 6, 7 and 12 joint arms.
+ *
+ * This is built twice: ModelBenchmark uses the MAX_JOINTS setting of the build, and
+ * ModelBenchmarkMaxJoints12 stores the joint-space data inside the model with a limit of 12 joints.
+ */
+
+#include "Benchmark.h"
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <cstdio>                                                                                   // std::printf
+
+using namespace RobotLibrary;
+
+int main()
+{
+     if(MaxJoints == Eigen::Dynamic) std::printf("Joint-space storage: heap (no limit)\n");
+     else                            std::printf("Joint-space storage: inside the model (limit of %d joints)\n", MaxJoints);
+     
+     std::printf("%8s %20s %20s\n", "joints", "update_state (us)", "full cycle (us)");
+     
+     for(unsigned int n : {6, 7, 12})
+     {
+          if(MaxJoints != Eigen::Dynamic and int(n) > MaxJoints) continue;                          // Too big for this build
+          
+          KinematicTree model(Test::write_serial_robot("benchmark_" + std::to_string(n) + ".urdf", n));
+          
+          ReferenceFrame *endpoint = model.find_frame("endpoint");
+          
+          Eigen::VectorXd jointPosition = Eigen::VectorXd::Constant(n, 0.3);
+          Eigen::VectorXd jointVelocity = Eigen::VectorXd::Constant(n,-0.2);
+          
+          Eigen::Matrix<double,6,Eigen::Dynamic> jacobianMatrix = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,n);
+          
+          unsigned int counter = 0;
+          
+          double kinematics = Benchmark::microseconds_per_call([&]
+          {
+               jointPosition(counter++ % n) += 1e-06;                                               // So the work can't be skipped
+               
+               model.update_state(jointPosition, jointVelocity);
+          }, 20000);
+          
+          double cycle = Benchmark::microseconds_per_call([&]
+          {
+               jointPosition(counter++ % n) += 1e-06;
+               
+               model.update_state(jointPosition, jointVelocity);
+               model.jacobian(endpoint, jacobianMatrix);
+               model.joint_inertia_matrix();
+               model.joint_coriolis_vector();
+               model.joint_gravity_vector();
+          }, 20000);
+          
+          std::printf("%8u %20.2f %20.2f\n", n, kinematics, cycle);
+     }
+     
+     return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file   ParallelBenchmark.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Finds where evaluating on the worker pool becomes faster than a single thread.
+ *
+ * It also times the batch kinematics, which evaluate 4 configurations at once in SIMD registers,
+ * against update_state() on one configuration at a time.
+ *
+ * Usage: ParallelBenchmark [numberOfThreads]
+ * The default is the number of concurrent threads supported by the hardware.
+ * Run it on the target machine, since the crossover depends on the number of cores.
+ */
+
+#include "Benchmark.h"
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <cstdio>                                                                                   // std::printf
+#include <cstdlib>                                                                                  // std::atoi
+
+using namespace RobotLibrary;
+
+int main(int argc, char **argv)
+{
+     unsigned int numberOfThreads = (argc > 1) ? std::atoi(argv[1]) : std::max(1U, std::thread::hardware_concurrency());
+     
+     std::printf("Comparing 1 thread against %u threads.\n\n", numberOfThreads);
+     
+     // Batches of joint configurations on a 7 joint arm
+     {
+          KinematicTree model(Test::write_serial_robot("parallel_benchmark_arm.urdf", 7));
+          
+          ReferenceFrame *endpoint = model.find_frame("endpoint");
+          
+          std::printf("Batches on a 7 joint arm (us per batch):\n");
+          std::printf("%8s %16s %16s %16s %16s\n", "batch", "pose (1)", "pose (N)", "dynamics (1)", "dynamics (N)");
+          
+          for(unsigned int m : {1, 2, 4, 8, 16, 32, 64, 128, 256, 1024})
+          {
+               Eigen::MatrixXd jointPositions = 0.5*Eigen::MatrixXd::Random(7,m);
+               Eigen::MatrixXd jointVelocities = Eigen::MatrixXd::Random(7,m);
+               
+               unsigned int calls = std::max(20U, 20000/m);
+               
+               double time[4];
+               
+               for(unsigned int k = 0; k < 2; ++k)
+               {
+                    model.set_number_of_threads(k == 0 ? 1 : numberOfThreads);
+                    
+                    time[k] = Benchmark::microseconds_per_call([&]
+                    {
+                         model.batch_frame_pose(endpoint, jointPositions);
+                    }, calls);
+                    
+                    time[k+2] = Benchmark::microseconds_per_call([&]
+                    {
+                         model.batch_inverse_dynamics(jointPositions, jointVelocities, jointVelocities);
+                    }, calls);
+               }
+               
+               std::printf("%8u %16.2f %16.2f %16.2f %16.2f\n", m, time[0], time[1], time[2], time[3]);
+          }
+     }
+     
+     // Configurations in SIMD lanes against one at a time, on a single thread
+     {
+          KinematicTree model(Test::write_serial_robot("parallel_benchmark_lanes.urdf", 7));
+          
+          model.set_number_of_threads(1);
+          
+          std::printf("\nbatch_forward_kinematics() against update_state() on a 7 joint arm, 1 thread (us per configuration):\n");
+          std::printf("%8s %16s %16s %10s\n", "batch", "lanes", "update_state", "speedup");
+          
+          for(unsigned int m : {4, 16, 64, 256, 1024, 4096})
+          {
+               Eigen::MatrixXd jointPositions = 0.5*Eigen::MatrixXd::Random(7,m);
+               Eigen::VectorXd jointVelocity = Eigen::VectorXd::Zero(7);
+               Eigen::MatrixXd linkPositions, linkRotations;                                        // Reused between calls
+               
+               unsigned int calls = std::max(20U, 20000/m);
+               
+               double lanes = Benchmark::microseconds_per_call([&]
+               {
+                    model.batch_forward_kinematics(jointPositions, linkPositions, linkRotations);
+               }, calls) / m;
+               
+               double scalar = Benchmark::microseconds_per_call([&]
+               {
+                    for(unsigned int j = 0; j < m; ++j) model.update_state(jointPositions.col(j), jointVelocity);
+               }, calls) / m;
+               
+               std::printf("%8u %16.3f %16.3f %10.2f\n", m, lanes, scalar, scalar/lanes);
+          }
+     }
+     
+     // Branches of a tree updated serially or in parallel
+     std::printf("\nupdate_state() on a trunk of 3 joints with 4 branches (us per call):\n");
+     std::printf("%16s %16s %16s\n", "links/branch", "serial", "parallel");
+     
+     for(unsigned int linksPerBranch : {2, 4, 8, 16, 32, 64})
+     {
+          KinematicTree model(Test::write_branched_robot("parallel_benchmark_tree.urdf", 3, 4, linksPerBranch));
+          
+          model.set_number_of_threads(numberOfThreads);
+          
+          unsigned int n = model.number_of_joints();
+          
+          Eigen::VectorXd jointPosition = Eigen::VectorXd::Constant(n, 0.3);
+          Eigen::VectorXd jointVelocity = Eigen::VectorXd::Zero(n);
+          
+          double time[2];
+          
+          for(unsigned int k = 0; k < 2; ++k)
+          {
+               if(k == 0) model.use_serial_kinematics();
+               else       model.use_parallel_kinematics();
+               
+               time[k] = Benchmark::microseconds_per_call([&]
+               {
+                    model.update_state(jointPosition, jointVelocity);
+               }, 5000);
+          }
+          
+          std::printf("%16u %16.2f %16.2f\n", linksPerBranch, time[0], time[1]);
+     }
+     
+     return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file   QPBenchmark.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Times the QP solvers on problems like those of a 6 or 7 joint arm.
+ *
+ * The fixed size solver uses the same interior point algorithm and settings as QPSolver, so the
+ * solutions should agree. The active set solver is compared with QPSolver on the problems that the
+ * controllers solve: a QP for a 6 joint arm, and a least squares problem for a 7 joint arm. It
+ * returns the exact solution, so the difference there is the error of the interior point algorithm.
+ * The largest difference between the solutions is printed with the timings.
+ */
+
+#include "ActiveSetSolver.h"
+#include "Benchmark.h"
+#include "FixedSizeQPSolver.h"
+#include "QPSolver.h"
+
+#include <algorithm>                                                                                // std::max
+#include <cstdio>                                                                                   // std::printf
+#include <cstdlib>                                                                                  // std::srand
+#include <vector>                                                                                   // std::vector
+
+using namespace RobotLibrary;
+
+/**
+ * Time both solvers on a batch of random problems with N variables and C general constraints.
+ */
+template <int N, int C>
+void compare()
+{
+     const unsigned int numberOfProblems = 100;
+
+     // Random problems like the control of an arm: H = J'*J + damping, joint limits, and C more constraints
+     std::vector<Eigen::MatrixXd> H(numberOfProblems), B(numberOfProblems);
+     std::vector<Eigen::VectorXd> f(numberOfProblems), z(numberOfProblems);
+
+     for(unsigned int i = 0; i < numberOfProblems; ++i)
+     {
+          Eigen::MatrixXd J = Eigen::MatrixXd::Random(6,N);
+          H[i] = J.transpose()*J + 0.1*Eigen::MatrixXd::Identity(N,N);
+          f[i] = -J.transpose()*Eigen::VectorXd::Random(6);
+          B[i] = Eigen::MatrixXd::Random(C,N);
+          z[i] = Eigen::VectorXd::Constant(C, 0.5);
+     }
+
+     Eigen::VectorXd xMin = Eigen::VectorXd::Constant(N,-1.0);
+     Eigen::VectorXd xMax = Eigen::VectorXd::Constant(N, 1.0);
+     Eigen::VectorXd x0   = Eigen::VectorXd::Zero(N);
+
+     QPSolver<double> dynamicSolver;
+     FixedSizeQPSolver<N,C> fixedSolver;
+
+     // The same problems as fixed size types, so the conversion is not timed
+     std::vector<typename FixedSizeQPSolver<N,C>::Matrix>           fixedH(H.begin(), H.end());
+     std::vector<typename FixedSizeQPSolver<N,C>::Vector>           fixedF(f.begin(), f.end());
+     std::vector<typename FixedSizeQPSolver<N,C>::ConstraintMatrix> fixedB(B.begin(), B.end());
+     std::vector<typename FixedSizeQPSolver<N,C>::ConstraintVector> fixedZ(z.begin(), z.end());
+
+     typename FixedSizeQPSolver<N,C>::Vector fixedMin = xMin, fixedMax = xMax, fixedX0 = x0;
+
+     double difference = 0.0;
+     for(unsigned int i = 0; i < numberOfProblems; ++i)
+     {
+          Eigen::VectorXd x = dynamicSolver.solve(H[i], f[i], xMin, xMax, B[i], z[i], x0);
+          Eigen::VectorXd y = fixedSolver.solve(fixedH[i], fixedF[i], fixedMin, fixedMax, fixedB[i], fixedZ[i], fixedX0);
+          difference = std::max(difference, (x - y).norm());
+     }
+
+     unsigned int counter = 0;
+
+     double dynamicTime = Benchmark::microseconds_per_call([&]
+     {
+          unsigned int i = counter++ % numberOfProblems;
+          dynamicSolver.solve(H[i], f[i], xMin, xMax, B[i], z[i], x0);
+     }, 20000);
+
+     double fixedTime = Benchmark::microseconds_per_call([&]
+     {
+          unsigned int i = counter++ % numberOfProblems;
+          fixedSolver.solve(fixedH[i], fixedF[i], fixedMin, fixedMax, fixedB[i], fixedZ[i], fixedX0);
+     }, 20000);
+
+     std::printf("%6d %6d %18.2f %18.2f %10.2f %14.1e\n", N, C, dynamicTime, fixedTime, dynamicTime/fixedTime, difference);
+}
+
+/**
+ * Time the active set and interior point methods on the problem solved by the controllers for an arm with N joints.
+ * For N <= 6 this is min 0.5*x'*H*x + x'*f, and for N > 6 it is min 0.5*(xd - x)'*W*(xd - x) subject to J*x = v,
+ * with joint speed limits as bounds and 1 more constraint for the singularity avoidance.
+ */
+template <int N>
+void compare_active_set()
+{
+     const unsigned int numberOfProblems = 100;
+
+     std::vector<Eigen::MatrixXd> J(numberOfProblems), H(numberOfProblems), B(numberOfProblems);
+     std::vector<Eigen::VectorXd> v(numberOfProblems), f(numberOfProblems), xd(numberOfProblems), z(numberOfProblems);
+
+     for(unsigned int i = 0; i < numberOfProblems; ++i)
+     {
+          J[i] = Eigen::MatrixXd::Random(6,N);
+          B[i] = Eigen::MatrixXd::Random(1,N);
+
+          Eigen::VectorXd feasible = 0.5*Eigen::VectorXd::Random(N);                                // So J*x = v can be satisfied within the bounds
+
+          if(N <= 6)
+          {
+               v[i] = 2.0*Eigen::VectorXd::Random(6);                                               // Fast enough that some bounds are active
+               H[i] = J[i].transpose()*J[i] + 0.01*Eigen::MatrixXd::Identity(N,N);
+               f[i] = -J[i].transpose()*v[i];
+          }
+          else
+          {
+               v[i]  = J[i]*feasible;
+               H[i]  = Eigen::MatrixXd::Identity(N,N) + 0.1*B[i].transpose()*B[i];                  // Like an inertia matrix
+               xd[i] = 2.0*Eigen::VectorXd::Random(N);                                              // Some bounds are active
+          }
+
+          z[i] = (B[i]*feasible).cwiseMax(0.0) + Eigen::VectorXd::Constant(1, 0.2);                  // Zero is inside, as it is in the controllers
+     }
+
+     Eigen::VectorXd xMin = Eigen::VectorXd::Constant(N,-1.0);
+     Eigen::VectorXd xMax = Eigen::VectorXd::Constant(N, 1.0);
+     Eigen::VectorXd x0   = Eigen::VectorXd::Zero(N);
+     Eigen::MatrixXd noA(0,N);
+     Eigen::VectorXd noY(0);
+
+     QPSolver<double> interiorPointSolver;
+     ActiveSetSolver<double> activeSetSolver;
+
+     auto interior_point = [&](const unsigned int &i) -> Eigen::VectorXd
+     {
+          if(N <= 6) return interiorPointSolver.solve(H[i], f[i], xMin, xMax, B[i], z[i], x0);
+          else       return interiorPointSolver.constrained_least_squares(xd[i], H[i], J[i], v[i], xMin, xMax, B[i], z[i], x0);
+     };
+
+     auto active_set = [&](const unsigned int &i) -> Eigen::VectorXd
+     {
+          if(N <= 6) return activeSetSolver.solve(H[i], f[i], noA, noY, xMin, xMax, B[i], z[i]);
+          else       return activeSetSolver.constrained_least_squares(xd[i], H[i], J[i], v[i], xMin, xMax, B[i], z[i]);
+     };
+
+     double difference = 0.0;
+     for(unsigned int i = 0; i < numberOfProblems; ++i)
+     {
+          difference = std::max(difference, (interior_point(i) - active_set(i)).norm());
+     }
+
+     unsigned int counter = 0;
+
+     double interiorPointTime = Benchmark::microseconds_per_call([&]
+     {
+          interior_point(counter++ % numberOfProblems);
+     }, 20000);
+
+     double activeSetTime = Benchmark::microseconds_per_call([&]
+     {
+          active_set(counter++ % numberOfProblems);
+     }, 20000);
+
+     std::printf("%6d %18.2f %18.2f %10.2f %14.1e\n", N, interiorPointTime, activeSetTime, interiorPointTime/activeSetTime, difference);
+}
+
+int main()
+{
+     std::srand(1);                                                                                 // Eigen's Random() uses std::rand()
+
+     std::printf("%6s %6s %18s %18s %10s %14s\n", "N", "C", "QPSolver (us)", "FixedSize (us)", "speedup", "difference");
+
+     compare<6,1>();
+     compare<7,1>();
+     compare<7,3>();
+     compare<7,10>();
+
+     std::printf("\n%6s %18s %18s %10s %14s\n", "N", "QPSolver (us)", "ActiveSet (us)", "speedup", "difference");
+
+     compare_active_set<6>();
+     compare_active_set<7>();
+
+     return 0;
+}
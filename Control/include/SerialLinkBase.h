@@ -8,6 +8,7 @@
 #ifndef SERIALLINKBASE_H_
 #define SERIALLINKBASE_H_
 
+#include "ActiveSetSolver.h"                                                                        // Alternative control optimisation
 #include <Eigen/Dense>                                                                              // Matrix decomposition
 #include "KinematicTree.h"                                                                          // Computes the kinematics and dynamics
 #include "MathFunctions.h"
@@ -161,6 +162,20 @@ class SerialLinkBase : public QPSolver<double>
 	     */
 	    double
 	    frequency() const { return _controlFrequency; }
+	    
+		/**
+		 * Solve the control optimisation with the dual active set method.
+		 * It keeps the factorisation of the Hessian, and updates it when constraints enter or leave
+		 * the working set. It returns the exact solution and does not need a start point.
+		 */
+		void
+		use_active_set_solver();
+		
+		/**
+		 * Solve the control optimisation with the interior point method inherited from QPSolver (default).
+		 */
+		void
+		use_interior_point_solver();
 		                           
 	protected:
 		
@@ -186,16 +201,28 @@ class SerialLinkBase : public QPSolver<double>
 		
 		Eigen::Matrix<double,6,6> _cartesianDamping = 0.1*_cartesianStiffness;                      ///< Gain the endpoint velocity error
 		
-		Eigen::Matrix<double,6,Eigen::Dynamic> _jacobianMatrix;                                     ///< Of the endpoint frame
+		JacobianMatrix _jacobianMatrix;                                                             ///< Of the endpoint frame
 		
 		Eigen::Matrix<double,6,6> _forceEllipsoid;                                                  ///< Jacobian multiplied with its tranpose: J*J.transpose()
 		
-		Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic> _constraintMatrix;                      ///< Used in optimisation during Cartesian control
+		Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic> _constraintMatrix;                      ///< Constraints other than joint limits, used in Cartesian control
+		
+		Eigen::VectorXd _constraintVector;                                                          ///< Constraints other than joint limits, used in Cartesian control
+		
+		Eigen::VectorXd _lowerBound;                                                                ///< Lower limit on joint control, used in Cartesian control
 		
-		Eigen::VectorXd _constraintVector;                                                          ///< Used in optimisation during Cartesian control
+		Eigen::VectorXd _upperBound;                                                                ///< Upper limit on joint control, used in Cartesian control
 		
 		Eigen::VectorXd _redundantTask;                                                             ///< Used to control null space of redundant robots
 		
+		Eigen::VectorXd _startPoint;                                                                ///< For the QP solver, kept so it is not reallocated every control loop
+		
+		Eigen::VectorXd _manipulabilityGradient;                                                    ///< Used in a few places, so it is computed once per control loop
+		
+		Eigen::MatrixXd _noConstraintMatrix;                                                        ///< 0xn, for problems with only the joint limits
+		
+		Eigen::VectorXd _noConstraintVector;                                                        ///< 0x1, for problems with only the joint limits
+		
 		KinematicTree* _model;                                                                      ///< Pointer to the underlying robot model
 		
 		Pose _endpointPose;                                                                         ///< Class denoting position and orientation of endpoint frame
@@ -203,6 +230,54 @@ class SerialLinkBase : public QPSolver<double>
 		ReferenceFrame *_endpointFrame;                                                             ///< Pointer to frame controlled in underlying model
 		
 		double _controlFrequency = 100.0;                                                           ///< Used in certain control calculations.
+		
+		enum QPMethod {interiorPoint, activeSet} _qpMethod = interiorPoint;                         ///< Which algorithm solves the control optimisation
+		
+		ActiveSetSolver<double> _activeSetSolver;                                                   ///< Keeps its factorisations between control loops
+		
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: xMin <= x <= xMax, B*x <= z, using the selected QP method.
+		 * @param H A positive definite Hessian matrix.
+		 * @param f A vector.
+		 * @param xMin The lower bound on x.
+		 * @param xMax The upper bound on x.
+		 * @param B The inequality constraint matrix.
+		 * @param z The inequality constraint vector.
+		 * @param x0 A start point for the interior point method; ignored by the active set method.
+		 * @return The optimal solution for x. It refers to the solver's memory, so it is overwritten on the next call.
+		 */
+		const Eigen::VectorXd&
+		solve_qp(const Eigen::MatrixXd &H,
+		         const Eigen::VectorXd &f,
+		         const Eigen::VectorXd &xMin,
+		         const Eigen::VectorXd &xMax,
+		         const Eigen::MatrixXd &B,
+		         const Eigen::VectorXd &z,
+		         const Eigen::VectorXd &x0);
+		
+		/**
+		 * Minimize 0.5*(xd - x)'*W*(xd - x) subject to: A*x = y, xMin <= x <= xMax, B*x <= z, using the selected QP method.
+		 * @param xd The desired value for the solution.
+		 * @param W A positive definite weighting matrix.
+		 * @param A The equality constraint matrix.
+		 * @param y The equality constraint vector.
+		 * @param xMin The lower bound on x.
+		 * @param xMax The upper bound on x.
+		 * @param B The inequality constraint matrix.
+		 * @param z The inequality constraint vector.
+		 * @param x0 A start point for the interior point method; ignored by the active set method.
+		 * @return The optimal solution for x. It refers to the solver's memory, so it is overwritten on the next call.
+		 */
+		const Eigen::VectorXd&
+		solve_constrained_least_squares(const Eigen::VectorXd &xd,
+		                                const Eigen::MatrixXd &W,
+		                                const Eigen::MatrixXd &A,
+		                                const Eigen::VectorXd &y,
+		                                const Eigen::VectorXd &xMin,
+		                                const Eigen::VectorXd &xMax,
+		                                const Eigen::MatrixXd &B,
+		                                const Eigen::VectorXd &z,
+		                                const Eigen::VectorXd &x0);
 	
 		/**
 		 * Computes the instantaneous limits on the joint control.
@@ -33,8 +33,9 @@ SerialKinematicControl::resolve_endpoint_motion(const Eigen::Vector<double,6> &e
     
     // Variables used in this scope
     unsigned int numJoints = _model->number_of_joints();                                            // Makes referencing easier       
-    VectorXd startPoint = _model->joint_velocities();                                               // Needed for the QP solver
-    VectorXd lowerBound(numJoints), upperBound(numJoints);                                          // Limits on joint control
+    bool warmStart = warm_start_enabled() and last_solution().size() == numJoints;                  // The QP solver resumes only from its last solution
+    if (warmStart) _startPoint = last_solution();
+    else           _startPoint = _model->joint_velocities();
 
     // Compute joint velocity limits and ensure the starting point is within bounds
     for (unsigned int i = 0; i < numJoints; ++i)
@@ -42,18 +43,19 @@ SerialKinematicControl::resolve_endpoint_motion(const Eigen::Vector<double,6> &e
         // NOTE: Size of bounds is not known at compile time,
         // so we must manually transfer values
         const auto &[lower, upper] = compute_control_limits(i);
-        lowerBound[i] = lower;
-        upperBound[i] = upper;
+        _lowerBound[i] = lower;
+        _upperBound[i] = upper;
 
-        startPoint[i] = std::clamp(startPoint[i], lower + 1e-03, upper - 1e-03);                    // Ensure within bounds of QP solver might fail
+        if (not warmStart)                                                                          // Must match the last solution exactly, the solver moves it inside the bounds
+        {
+            _startPoint[i] = std::clamp(_startPoint[i], lower + 1e-03, upper - 1e-03);              // Ensure within bounds of QP solver might fail
+        }
     }
 
     // Compute manipulability gradient once and update constraints
-    const VectorXd manipulabilityGradient = manipulability_gradient();                              // Used in a few places, so compute it once here
-    _constraintMatrix.row(2 * numJoints) = -manipulabilityGradient.transpose();                     // Part of the control barrier function
-    _constraintVector.head(numJoints) = upperBound;
-    _constraintVector.segment(numJoints, numJoints) = -lowerBound;
-    _constraintVector(2 * numJoints) = (_manipulability - _minManipulability) * 100 * sqrt(_controlFrequency);
+    _manipulabilityGradient = manipulability_gradient();                                            // Used in a few places, so compute it once here
+    _constraintMatrix.row(0) = -_manipulabilityGradient.transpose();                                // Part of the control barrier function
+    _constraintVector(0) = (_manipulability - _minManipulability) * 100 * sqrt(_controlFrequency);
 
     VectorXd controlVelocity = VectorXd::Zero(numJoints);                                           // We need to compute this
 
@@ -63,41 +65,47 @@ SerialKinematicControl::resolve_endpoint_motion(const Eigen::Vector<double,6> &e
         {
             // Solve a problem of the form:
             // min 0.5*x'*H*x + x'*f
-            // subject to: B*x <= z
+            // subject to: x_min <= x <= x_max
+            //             B*x <= z
 
             // See: github.com/Woolfrey/software_simple_qp
             
-            controlVelocity = QPSolver<double>::solve(
+            controlVelocity = solve_qp(
                 _jacobianMatrix.transpose() * _jacobianMatrix,                                      // H
                -_jacobianMatrix.transpose() * endpointMotion,                                       // f
+                _lowerBound,                                                                        // x_min
+                _upperBound,                                                                        // x_max
                 _constraintMatrix,                                                                  // B
                 _constraintVector,                                                                  // z
-                startPoint                                                                          // Initial guess
+                _startPoint                                                                         // Initial guess
             );
         }
         else                                                                                        // Redundant robot
         {
             if (not _redundantTaskSet)
             {
-                _redundantTask = manipulabilityGradient * sqrt(_controlFrequency) / 5.0;   
+                _redundantTask = _manipulabilityGradient * sqrt(_controlFrequency) / 5.0;   
                 _redundantTaskSet = false;                                                          // Set false for next control loop
             }
 
             // Solve a problem of the form:
             // min (x_d - x)'*W*(x_d - x)
             // subject to: A*x = y
+            //             x_min <= x <= x_max
             //             B*x < z
 
             // See: github.com/Woolfrey/software_simple_qp
             
-            controlVelocity = QPSolver<double>::constrained_least_squares(
+            controlVelocity = solve_constrained_least_squares(
                 _redundantTask,                                                                     // x_d
                 _model->joint_inertia_matrix(),                                                     // W
                 _jacobianMatrix,                                                                    // A
                 endpointMotion,                                                                     // y
+                _lowerBound,                                                                        // x_min
+                _upperBound,                                                                        // x_max
                 _constraintMatrix,                                                                  // B
                 _constraintVector,                                                                  // z
-                startPoint                                                                          // Initial guess
+                _startPoint                                                                         // Initial guess
             );
         }
     }
@@ -113,18 +121,20 @@ SerialKinematicControl::resolve_endpoint_motion(const Eigen::Vector<double,6> &e
 
         // Solve a problem of the form:
         // min 0.5*x'*H*x + x'*f
-        // subject to: B*x <= z
+        // subject to: x_min <= x <= x_max
         
         MatrixXd H = _jacobianMatrix.transpose() * _jacobianMatrix; 
         
         H.diagonal().array() += dampingFactor;
         
-        controlVelocity = QPSolver<double>::solve(
+        controlVelocity = solve_qp(
             H,
            -_jacobianMatrix.transpose() * endpointMotion,
-            _constraintMatrix.block(0, 0, 2 * numJoints, numJoints),                                // Use only first 2*numJoints rows
-            _constraintVector.head(2 * numJoints),                                                  // Use only first 2*numJoints elements
-            startPoint
+            _lowerBound,
+            _upperBound,
+            _noConstraintMatrix,                                                                    // Only the joint limits
+            _noConstraintVector,
+            _startPoint
         );
     }
 
@@ -23,28 +23,29 @@ SerialLinkBase::SerialLinkBase(KinematicTree *model,
      
      _endpointFrame = _model->find_frame(endpointName);
      
+     _jacobianMatrix.setZero(6,_model->number_of_joints());                                         // Columns for joints that don't move the endpoint remain zero
+     
      update();                                                                                      // Compute initial state
      
      QPSolver::set_barrier_reduction_rate(0.9);
      QPSolver::set_barrier_scalar(1000.0);
 
-     // Resize dimensions of inequality constraints for the QP solver: B*qdot < z, where:
+     // Resize dimensions of constraints for the QP solver: qdot_min <= qdot <= qdot_max, B*qdot < z, where:
+     //
+     // B = [ -(dm/dq)' ]   z = [ (m - m_min) ]
      //
-     // B = [      I    ]   z = [    qdot_max  ]
-     //     [     -I    ]       [   -qdot_min  ]
-     //     [  (dm/dq)' ]       [  (m - m_min) ]
+     // The joint limits are passed to the solver as bounds, so they don't need rows in B.
      
      unsigned int n = _model->number_of_joints();
      
-     _constraintMatrix.resize(2*n+1,n);
-     _constraintMatrix.block(0,0,n,n).setIdentity();
-     _constraintMatrix.block(n,0,n,n) = -_constraintMatrix.block(0,0,n,n);
-//   _constraintMatrix.row(2*n) = this->manipulability_gradient();                            <-- Needs to be set in the control loop
-
-     _constraintVector.resize(2*n+1);
-//   _constraintVector.block(0,0,n,1) =  upperBound;                                          <-- Needs to be set in the control loop
-//   _constraintVector.block(n,0,n,1) = -lowerBound;                                          <-- Needs to be set in the control loop
-//   _constraintVector(2*n) = _manipulability - _minManipulability;               <-- Needs to be set in the control loop
+     _lowerBound.resize(n);                                                                   // <-- Needs to be set in the control loop
+     _upperBound.resize(n);                                                                   // <-- Needs to be set in the control loop
+     _constraintMatrix.resize(1,n);                                                           // <-- Needs to be set in the control loop
+     _constraintVector.resize(1);                                                             // <-- Needs to be set in the control loop
+     _startPoint.resize(n);                                                                   // <-- Needs to be set in the control loop
+     _manipulabilityGradient.resize(n);                                                       // <-- Needs to be set in the control loop
+     _noConstraintMatrix.resize(0,n);
+     _noConstraintVector.resize(0);
 
      std::cout << "[INFO] [SERIAL LINK CONTROL] Controlling the '" << endpointName << "' frame on the '" 
                << _model->name() << "' robot." << std::endl;
@@ -58,7 +59,7 @@ SerialLinkBase::update()
 {
 	_endpointPose = _endpointFrame->link->pose() * _endpointFrame->relativePose;                    // Compute new endpoint pose
 	                      
-    _jacobianMatrix = _model->jacobian(_endpointFrame);                                             // Jacobian for the endpoint
+    _model->jacobian(_endpointFrame, _jacobianMatrix);                                              // Jacobian for the endpoint
 	                      
 	_forceEllipsoid = _jacobianMatrix*_jacobianMatrix.transpose();                                  // Used for certain calculations
 	
@@ -67,6 +68,62 @@ SerialLinkBase::update()
 	_manipulability = ( temp < 0 or std::isnan(temp)) ? 0.0 : temp;                                 // Rounding error can mean manipulability is negative or nan
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Solve the control optimisation with the dual active set method                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+SerialLinkBase::use_active_set_solver()
+{
+    _qpMethod = activeSet;
+
+    std::cout << "[INFO] [SERIAL LINK CONTROL] Using the active set method to solve the control optimisation.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Solve the control optimisation with the interior point method                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+SerialLinkBase::use_interior_point_solver()
+{
+    _qpMethod = interiorPoint;
+
+    std::cout << "[INFO] [SERIAL LINK CONTROL] Using the interior point method to solve the control optimisation.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //  Solve min 0.5*x'*H*x + x'*f subject to: xMin <= x <= xMax, B*x <= z with the selected method   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+const Eigen::VectorXd&
+SerialLinkBase::solve_qp(const Eigen::MatrixXd &H,
+                         const Eigen::VectorXd &f,
+                         const Eigen::VectorXd &xMin,
+                         const Eigen::VectorXd &xMax,
+                         const Eigen::MatrixXd &B,
+                         const Eigen::VectorXd &z,
+                         const Eigen::VectorXd &x0)
+{
+    if(_qpMethod == activeSet) return _activeSetSolver.solve(H, f, Eigen::MatrixXd(0, H.cols()), Eigen::VectorXd(0), xMin, xMax, B, z);
+    else                       return QPSolver<double>::solve(H, f, xMin, xMax, B, z, x0);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //       Solve min 0.5*(xd - x)'*W*(xd - x) subject to: A*x = y, bounds, B*x <= z                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+const Eigen::VectorXd&
+SerialLinkBase::solve_constrained_least_squares(const Eigen::VectorXd &xd,
+                                                const Eigen::MatrixXd &W,
+                                                const Eigen::MatrixXd &A,
+                                                const Eigen::VectorXd &y,
+                                                const Eigen::VectorXd &xMin,
+                                                const Eigen::VectorXd &xMax,
+                                                const Eigen::MatrixXd &B,
+                                                const Eigen::VectorXd &z,
+                                                const Eigen::VectorXd &x0)
+{
+    if(_qpMethod == activeSet) return _activeSetSolver.constrained_least_squares(xd, W, A, y, xMin, xMax, B, z);
+    else                       return QPSolver<double>::constrained_least_squares(xd, W, A, y, xMin, xMax, B, z, x0);
+}
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                        Set the gains for Cartesian feedback control                           //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,662 @@
+/**
+ * @file   ActiveSetSolver.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  A dual active set method for solving convex QP problems.
+ */
+
+#ifndef ACTIVESETSOLVER_H_
+#define ACTIVESETSOLVER_H_
+
+#include <algorithm>                                                                                // std::min
+#include <cmath>                                                                                    // std::abs, std::hypot
+#include <Eigen/Dense>                                                                              // Eigen::Matrix, Eigen::Vector, and decompositions
+#include <iostream>                                                                                 // std::cerr
+#include <limits>                                                                                   // std::numeric_limits
+#include <stdexcept>                                                                                // std::invalid_argument, std::runtime_error
+#include <string>                                                                                   // std::to_string
+#include <vector>                                                                                   // std::vector
+
+/**
+ * Solves problems of the form min 0.5*x'*H*x + x'*f subject to: A*x = y, B*x <= z,
+ * where H is positive definite, using the dual method of Goldfarb & Idnani (1983).
+ *
+ * It starts from the unconstrained minimum and adds the most violated constraint on each step.
+ * The Cholesky factorisation of H is computed once. When a constraint enters or leaves the
+ * working set, the QR factors of the active constraints are updated with Givens rotations,
+ * so each step costs O(n^2) instead of a new O(n^3) factorisation. The factorisation of H
+ * is also kept between calls, and reused if H does not change. In a control loop H usually
+ * depends on the state, e.g. J'*J or the inertia matrix, so it is refactorised on most calls.
+ * All memory is kept between calls, so solving problems of the same size does not allocate
+ * on the heap. The returned solution refers to this memory, so it is overwritten on the next call.
+ *
+ * A constraint that is linearly dependent on the working set is dropped, like in eiquadprog.
+ * It is already satisfied at the point it would have been added.
+ *
+ * Goldfarb, D., & Idnani, A. (1983). A numerically stable dual method for solving strictly
+ * convex quadratic programs. Mathematical Programming, 27(1), 1-33.
+ */
+template <class DataType = double>
+class ActiveSetSolver
+{
+	public:
+
+		/**
+		 * Empty constructor.
+		 */
+		ActiveSetSolver() {}
+
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: B*x <= z.
+		 * @param H A positive definite Hessian matrix (nxn).
+		 * @param f A vector (nx1).
+		 * @param B The inequality constraint matrix (cxn).
+		 * @param z The inequality constraint vector (cx1).
+		 * @return The optimal solution for x.
+		 */
+		const Eigen::Vector<DataType,Eigen::Dynamic>&
+		solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+		      const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &z);
+
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: A*x = y, B*x <= z.
+		 * @param H A positive definite Hessian matrix (nxn).
+		 * @param f A vector (nx1).
+		 * @param A The equality constraint matrix (mxn).
+		 * @param y The equality constraint vector (mx1).
+		 * @param B The inequality constraint matrix (cxn).
+		 * @param z The inequality constraint vector (cx1).
+		 * @return The optimal solution for x.
+		 */
+		const Eigen::Vector<DataType,Eigen::Dynamic>&
+		solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+		      const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+		      const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &z);
+
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: A*x = y, xMin <= x <= xMax, B*x <= z.
+		 * The bounds are handled element-wise, so B only needs the rows that are not simple bounds.
+		 * @param H A positive definite Hessian matrix (nxn).
+		 * @param f A vector (nx1).
+		 * @param A The equality constraint matrix (mxn).
+		 * @param y The equality constraint vector (mx1).
+		 * @param xMin The lower bound (nx1). Elements may be -infinity.
+		 * @param xMax The upper bound (nx1). Elements may be +infinity.
+		 * @param B The inequality constraint matrix (cxn).
+		 * @param z The inequality constraint vector (cx1).
+		 * @return The optimal solution for x.
+		 */
+		const Eigen::Vector<DataType,Eigen::Dynamic>&
+		solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+		      const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &xMin,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &xMax,
+		      const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+		      const Eigen::Vector<DataType,Eigen::Dynamic>                &z);
+
+		/**
+		 * Minimize 0.5*(xd - x)'*W*(xd - x) subject to: A*x = y, B*x <= z.
+		 * @param xd The desired value for the solution (nx1).
+		 * @param W A positive definite weighting matrix (nxn).
+		 * @param A The equality constraint matrix (mxn).
+		 * @param y The equality constraint vector (mx1).
+		 * @param B The inequality constraint matrix (cxn).
+		 * @param z The inequality constraint vector (cx1).
+		 * @return The optimal solution for x.
+		 */
+		const Eigen::Vector<DataType,Eigen::Dynamic>&
+		constrained_least_squares(const Eigen::Vector<DataType,Eigen::Dynamic>                &xd,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &W,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &z)
+		{
+			this->linearTerm.noalias() = -W*xd;
+
+			return solve(W, this->linearTerm, A, y, B, z);
+		}
+
+		/**
+		 * Minimize 0.5*(xd - x)'*W*(xd - x) subject to: A*x = y, xMin <= x <= xMax, B*x <= z.
+		 * @param xd The desired value for the solution (nx1).
+		 * @param W A positive definite weighting matrix (nxn).
+		 * @param A The equality constraint matrix (mxn).
+		 * @param y The equality constraint vector (mx1).
+		 * @param xMin The lower bound (nx1). Elements may be -infinity.
+		 * @param xMax The upper bound (nx1). Elements may be +infinity.
+		 * @param B The inequality constraint matrix (cxn).
+		 * @param z The inequality constraint vector (cx1).
+		 * @return The optimal solution for x.
+		 */
+		const Eigen::Vector<DataType,Eigen::Dynamic>&
+		constrained_least_squares(const Eigen::Vector<DataType,Eigen::Dynamic>                &xd,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &W,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &xMin,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &xMax,
+		                          const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+		                          const Eigen::Vector<DataType,Eigen::Dynamic>                &z)
+		{
+			this->linearTerm.noalias() = -W*xd;
+
+			return solve(W, this->linearTerm, A, y, xMin, xMax, B, z);
+		}
+
+		/**
+		 * Set the maximum number of times a constraint may be added or removed before terminating.
+		 * @param number The maximum number of steps.
+		 * @return Returns false if the input argument is invalid.
+		 */
+		bool
+		set_num_steps(const unsigned int &number);
+
+		/**
+		 * @return The number of times a constraint was added or removed on the last call.
+		 */
+		unsigned int
+		num_steps() const { return this->numSteps; }
+
+		/**
+		 * @return The number of constraints in the working set at the last solution, including equality constraints.
+		 */
+		unsigned int
+		num_active_constraints() const { return this->numActive; }
+
+		/**
+		 * @return The solution from the last call.
+		 */
+		Eigen::Vector<DataType,Eigen::Dynamic>
+		last_solution() const { return this->x; }
+
+	private:
+
+		bool factorised = false;                                                                    ///< True if L holds the factorisation of hessian
+
+		unsigned int maxSteps = 100;                                                                ///< Maximum number of changes to the working set
+
+		unsigned int numSteps = 0;                                                                  ///< Number of changes to the working set on the last call
+
+		unsigned int numActive = 0;                                                                 ///< Number of constraints in the working set
+
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> hessian;                              ///< The last Hessian that was factorised
+
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> L;                                    ///< Cholesky factor H = L*L'
+
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> invLt;                                ///< Inverse of L', the start point for J
+
+		Eigen::LLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> cholesky;                 ///< Kept so that refactorising does not allocate
+
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> J;                                    ///< J = L^-T*Q, where N = Q*R are the active constraint normals
+
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> R;                                    ///< Upper triangular factor of the active constraint normals
+
+		Eigen::Vector<DataType,Eigen::Dynamic> x;                                                   ///< The decision variable
+
+		Eigen::Vector<DataType,Eigen::Dynamic> multipliers;                                         ///< Lagrange multipliers for the working set
+
+		Eigen::Vector<DataType,Eigen::Dynamic> d;                                                   ///< J'*n for the constraint being added
+
+		Eigen::Vector<DataType,Eigen::Dynamic> r;                                                   ///< Change in multipliers of the working set
+
+		Eigen::Vector<DataType,Eigen::Dynamic> step;                                                ///< Step direction in the primal space
+
+		Eigen::Vector<DataType,Eigen::Dynamic> linearTerm;                                          ///< -W*xd for least squares problems
+
+		Eigen::Vector<DataType,Eigen::Dynamic> noLowerBound;                                        ///< -inf, for problems without bounds
+
+		Eigen::Vector<DataType,Eigen::Dynamic> noUpperBound;                                        ///< +inf, for problems without bounds
+
+		std::vector<int> workingSet;                                                                ///< Index of each active constraint; equality constraints are -1, -2, ...
+
+		std::vector<bool> isActive;                                                                 ///< Which inequality constraints are in the working set; upper bounds, lower bounds, then rows of B
+
+		/**
+		 * Add a constraint to the working set by updating the QR factors with Givens rotations.
+		 * @return False if the constraint is linearly dependent on the working set.
+		 */
+		bool
+		add_constraint();
+
+		/**
+		 * Remove a constraint from the working set and restore the triangular form of R with Givens rotations.
+		 * @param position The position of the constraint in the working set.
+		 */
+		void
+		remove_constraint(const unsigned int &position);
+
+		/**
+		 * Compute the step direction in the primal space, and the change in multipliers, for adding a constraint.
+		 * On entry, d must hold J'*n, where n is the normal of the constraint pointing in to the feasible side.
+		 */
+		void
+		compute_step();
+
+};                                                                                                  // Semicolon needed after class declaration
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Solve a problem of the form min 0.5*x'*H*x + x'*f subject to: B*x <= z             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+const Eigen::Vector<DataType,Eigen::Dynamic>&
+ActiveSetSolver<DataType>::solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+                                 const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &z)
+{
+	return solve(H, f, Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>(0, H.cols()),
+	                   Eigen::Vector<DataType,Eigen::Dynamic>(0), B, z);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //        Solve a problem of the form min 0.5*x'*H*x + x'*f subject to: A*x = y, B*x <= z         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+const Eigen::Vector<DataType,Eigen::Dynamic>&
+ActiveSetSolver<DataType>::solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+                                 const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+                                 const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &z)
+{
+	if(this->noLowerBound.size() != H.rows())
+	{
+		this->noLowerBound.setConstant(H.rows(),-std::numeric_limits<DataType>::infinity());
+		this->noUpperBound.setConstant(H.rows(), std::numeric_limits<DataType>::infinity());
+	}
+
+	return solve(H, f, A, y, this->noLowerBound, this->noUpperBound, B, z);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Solve min 0.5*x'*H*x + x'*f subject to: A*x = y, xMin <= x <= xMax, B*x <= z          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+const Eigen::Vector<DataType,Eigen::Dynamic>&
+ActiveSetSolver<DataType>::solve(const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &H,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &f,
+                                 const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &A,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &y,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &xMin,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &xMax,
+                                 const Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &B,
+                                 const Eigen::Vector<DataType,Eigen::Dynamic>                &z)
+{
+	unsigned int n = H.rows();                                                                      // Dimensions of the decision variable
+	unsigned int m = A.rows();                                                                      // Number of equality constraints
+	unsigned int c = B.rows();                                                                      // Number of inequality constraints
+
+	// Ensure input arguments are sound
+	if(H.cols() != n or f.size() != n or A.cols() != n or B.cols() != n)
+	{
+		throw std::invalid_argument("[ERROR] [ACTIVE SET SOLVER] solve(): "
+		                            "Dimensions of arguments for the decision variable do not match. "
+		                            "The Hessian matrix was " + std::to_string(H.rows()) + "x" + std::to_string(H.cols()) + ", "
+		                            "the f vector had " + std::to_string(f.size()) + " elements, "
+		                            "the equality constraint matrix had " + std::to_string(A.cols()) + " columns, and "
+		                            "the inequality constraint matrix had " + std::to_string(B.cols()) + " columns.");
+	}
+	else if(y.size() != m or z.size() != c)
+	{
+		throw std::invalid_argument("[ERROR] [ACTIVE SET SOLVER] solve(): "
+		                            "Dimensions of the constraints do not match. "
+		                            "The equality constraint had " + std::to_string(A.rows()) + " rows and "
+		                            + std::to_string(y.size()) + " elements, and the inequality constraint had "
+		                            + std::to_string(B.rows()) + " rows and " + std::to_string(z.size()) + " elements.");
+	}
+	else if(xMin.size() != n or xMax.size() != n)
+	{
+		throw std::invalid_argument("[ERROR] [ACTIVE SET SOLVER] solve(): "
+		                            "Dimensions of the bounds do not match. "
+		                            "The decision variable has " + std::to_string(n) + " elements, "
+		                            "the lower bound had " + std::to_string(xMin.size()) + " elements, and "
+		                            "the upper bound had " + std::to_string(xMax.size()) + " elements.");
+	}
+	else if(m > n)
+	{
+		throw std::invalid_argument("[ERROR] [ACTIVE SET SOLVER] solve(): "
+		                            "There are more equality constraints (" + std::to_string(m) + ") "
+		                            "than decision variables (" + std::to_string(n) + ").");
+	}
+
+	// Factorise the Hessian only if it has changed since the last call. Comparing costs O(n^2),
+	// so it is cheap even when H changes every call, as it does in the controllers.
+	if(not this->factorised or this->hessian.rows() != n or this->hessian != H)
+	{
+		this->cholesky.compute(H);
+
+		if(this->cholesky.info() != Eigen::Success)
+		{
+			this->factorised = false;
+
+			throw std::runtime_error("[ERROR] [ACTIVE SET SOLVER] solve(): "
+			                         "The Hessian matrix is not positive definite.");
+		}
+
+		this->hessian = H;
+		this->L       = this->cholesky.matrixL();
+		this->invLt.setIdentity(n,n);
+		this->L.transpose().template triangularView<Eigen::Upper>().solveInPlace(this->invLt);
+
+		this->factorised = true;
+	}
+
+	// Start from the unconstrained minimum, with an empty working set
+	this->x = -f;
+	this->L.template triangularView<Eigen::Lower>().solveInPlace(this->x);
+	this->L.transpose().template triangularView<Eigen::Upper>().solveInPlace(this->x);              // x = -H^-1*f
+
+	this->J = this->invLt;
+	this->R.setZero(n,n);
+	this->multipliers.setZero(n+1);
+	this->r.setZero(n+1);
+	this->workingSet.assign(n+1, 0);
+	this->isActive.assign(2*n + c, false);
+	this->numActive = 0;
+	this->numSteps  = 0;
+
+	// Add the equality constraints; they are never removed
+	for(unsigned int i = 0; i < m; i++)
+	{
+		this->d.noalias() = this->J.transpose()*A.row(i).transpose();
+		compute_step();
+
+		// Full step to satisfy the constraint
+		DataType t = 0;
+		DataType stepNormal = this->step.dot(A.row(i));
+		if(std::abs(stepNormal) > std::numeric_limits<DataType>::epsilon())
+		{
+			t = (y(i) - A.row(i).dot(this->x)) / stepNormal;
+		}
+
+		this->workingSet[this->numActive] = -1 - int(i);
+
+		if(not add_constraint()) continue;                                                          // Dependent, so drop it
+
+		this->x += t*this->step;
+		this->multipliers(this->numActive-1) = t;
+		this->multipliers.head(this->numActive-1) -= t*this->r.head(this->numActive-1);
+	}
+
+	unsigned int numEquality = this->numActive;                                                     // Any dependent ones were dropped
+
+	// Inequality constraint j is written as b_j'*x <= z_j. The first n are the upper bounds with
+	// b_j = e_j, the next n are the lower bounds with b_j = -e_j, and the rest are the rows of B.
+	auto normal_dot = [&](const unsigned int &j, const Eigen::Vector<DataType,Eigen::Dynamic> &v) -> DataType
+	{
+		     if(j < n)   return  v(j);
+		else if(j < 2*n) return -v(j-n);
+		else             return B.row(j-2*n).dot(v);
+	};
+
+	auto limit = [&](const unsigned int &j) -> DataType
+	{
+		     if(j < n)   return  xMax(j);
+		else if(j < 2*n) return -xMin(j-n);
+		else             return z(j-2*n);
+	};
+
+	// Size of the constraints scales the feasibility tolerance
+	DataType largest = (c > 0) ? z.cwiseAbs().maxCoeff() : DataType(0);
+	for(unsigned int j = 0; j < n; j++)
+	{
+		if(std::isfinite(xMax(j))) largest = std::max(largest, std::abs(xMax(j)));
+		if(std::isfinite(xMin(j))) largest = std::max(largest, std::abs(xMin(j)));
+	}
+	DataType tolerance = 1e-10 * (1.0 + largest);
+
+	// Add the most violated inequality constraint until all are satisfied
+	while(true)
+	{
+		// Find the most violated inequality constraint
+		int newConstraint = -1;
+		DataType maxViolation = tolerance;
+		for(unsigned int j = 0; j < 2*n + c; j++)
+		{
+			if(this->isActive[j]) continue;
+
+			DataType violation = normal_dot(j, this->x) - limit(j);                                 // Infinite bounds are never violated
+
+			if(violation > maxViolation)
+			{
+				maxViolation  = violation;
+				newConstraint = j;
+			}
+		}
+
+		if(newConstraint < 0) return this->x;                                                       // All constraints satisfied; solution is optimal
+
+		unsigned int j = newConstraint;                                                             // Now known to be valid
+
+		this->multipliers(this->numActive) = 0;
+
+		// Step towards the new constraint, removing any that block the way
+		while(true)
+		{
+			if(this->numSteps++ >= this->maxSteps)
+			{
+				throw std::runtime_error("[ERROR] [ACTIVE SET SOLVER] solve(): "
+				                         "Exceeded the maximum of " + std::to_string(this->maxSteps) + " steps.");
+			}
+
+			// b'*x <= z is the same as -b'*x >= -z, so the normal is -b
+			     if(j < n)   this->d = -this->J.row(j).transpose();
+			else if(j < 2*n) this->d =  this->J.row(j-n).transpose();
+			else             this->d.noalias() = -this->J.transpose()*B.row(j-2*n).transpose();
+
+			compute_step();
+
+			// Partial step: largest step in the dual space before a multiplier becomes negative
+			DataType partialStep = std::numeric_limits<DataType>::infinity();
+			unsigned int blocking = 0;
+			for(unsigned int k = numEquality; k < this->numActive; k++)                             // Equality multipliers may be negative
+			{
+				if(this->r(k) > 0 and this->multipliers(k) / this->r(k) < partialStep)
+				{
+					partialStep = this->multipliers(k) / this->r(k);
+					blocking    = k;
+				}
+			}
+
+			// Full step: the step in the primal space that satisfies the new constraint
+			DataType fullStep = std::numeric_limits<DataType>::infinity();
+			DataType stepNormal = -normal_dot(j, this->step);
+			if(std::abs(stepNormal) > std::numeric_limits<DataType>::epsilon())
+			{
+				fullStep = (normal_dot(j, this->x) - limit(j)) / stepNormal;
+			}
+
+			DataType t = std::min(partialStep, fullStep);
+
+			if(t == std::numeric_limits<DataType>::infinity())
+			{
+				throw std::runtime_error("[ERROR] [ACTIVE SET SOLVER] solve(): "
+				                         "The constraints cannot be satisfied.");
+			}
+
+			if(fullStep < std::numeric_limits<DataType>::infinity()) this->x += t*this->step;       // No primal step if new constraint is dependent
+
+			this->multipliers.head(this->numActive) -= t*this->r.head(this->numActive);
+			this->multipliers(this->numActive) += t;
+
+			if(t == fullStep)
+			{
+				this->workingSet[this->numActive] = j;
+
+				if(add_constraint()) this->isActive[j] = true;                                      // Otherwise dependent, so drop it
+
+				break;                                                                              // Look for the next violated constraint
+			}
+			else
+			{
+				this->isActive[this->workingSet[blocking]] = false;
+
+				remove_constraint(blocking);                                                        // Then try again
+			}
+		}
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Compute the primal step direction and change in multipliers                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+void
+ActiveSetSolver<DataType>::compute_step()
+{
+	unsigned int n = this->J.rows();
+
+	this->step.noalias() = this->J.rightCols(n - this->numActive) * this->d.tail(n - this->numActive); // Projection on to null space of working set
+
+	this->r.head(this->numActive) = this->d.head(this->numActive);
+	this->R.topLeftCorner(this->numActive,this->numActive).template triangularView<Eigen::Upper>().solveInPlace(this->r.head(this->numActive));
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Add a constraint to the working set by updating the QR factors                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+bool
+ActiveSetSolver<DataType>::add_constraint()
+{
+	unsigned int n = this->J.rows();
+
+	// Rotate d so that only its first numActive+1 elements are non-zero,
+	// and apply the same rotations to the columns of J
+	for(unsigned int j = n-1; j > this->numActive; j--)
+	{
+		DataType cc = this->d(j-1);
+		DataType ss = this->d(j);
+		DataType h  = std::hypot(cc, ss);
+
+		if(h == 0) continue;
+
+		this->d(j) = 0;
+		cc /= h;
+		ss /= h;
+
+		if(cc < 0)
+		{
+			cc = -cc;
+			ss = -ss;
+			this->d(j-1) = -h;
+		}
+		else this->d(j-1) = h;
+
+		DataType xny = ss / (1.0 + cc);
+
+		for(unsigned int k = 0; k < n; k++)
+		{
+			DataType t1 = this->J(k,j-1);
+			DataType t2 = this->J(k,j);
+			this->J(k,j-1) = t1*cc + t2*ss;
+			this->J(k,j)   = xny*(t1 + this->J(k,j-1)) - t2;
+		}
+	}
+
+	// The new column of R
+	this->R.col(this->numActive).head(this->numActive+1) = this->d.head(this->numActive+1);
+
+	if(std::abs(this->d(this->numActive)) <= std::numeric_limits<DataType>::epsilon() * this->R.diagonal().cwiseAbs().maxCoeff())
+	{
+		return false;                                                                               // Linearly dependent
+	}
+
+	this->numActive++;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Remove a constraint from the working set and restore R to triangular form            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+void
+ActiveSetSolver<DataType>::remove_constraint(const unsigned int &position)
+{
+	unsigned int n = this->J.rows();
+
+	// Shift everything after this constraint down one place, including the multiplier
+	// for the constraint currently being added, which is stored just past the working set
+	for(unsigned int i = position; i < this->numActive; i++)
+	{
+		this->workingSet[i]  = this->workingSet[i+1];
+		this->multipliers(i) = this->multipliers(i+1);
+		if(i+1 < this->numActive) this->R.col(i) = this->R.col(i+1);
+	}
+
+	this->multipliers(this->numActive) = 0;
+	this->R.col(this->numActive-1).setZero();
+	this->numActive--;
+
+	// R now has non-zero elements below the diagonal; rotate them away
+	for(unsigned int j = position; j < this->numActive; j++)
+	{
+		DataType cc = this->R(j,j);
+		DataType ss = this->R(j+1,j);
+		DataType h  = std::hypot(cc, ss);
+
+		if(h == 0) continue;
+
+		cc /= h;
+		ss /= h;
+		this->R(j+1,j) = 0;
+
+		if(cc < 0)
+		{
+			this->R(j,j) = -h;
+			cc = -cc;
+			ss = -ss;
+		}
+		else this->R(j,j) = h;
+
+		DataType xny = ss / (1.0 + cc);
+
+		for(unsigned int k = j+1; k < this->numActive; k++)
+		{
+			DataType t1 = this->R(j,k);
+			DataType t2 = this->R(j+1,k);
+			this->R(j,k)   = t1*cc + t2*ss;
+			this->R(j+1,k) = xny*(t1 + this->R(j,k)) - t2;
+		}
+
+		for(unsigned int k = 0; k < n; k++)
+		{
+			DataType t1 = this->J(k,j);
+			DataType t2 = this->J(k,j+1);
+			this->J(k,j)   = t1*cc + t2*ss;
+			this->J(k,j+1) = xny*(this->J(k,j) + t1) - t2;
+		}
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Set the maximum number of changes to the working set                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+bool
+ActiveSetSolver<DataType>::set_num_steps(const unsigned int &number)
+{
+	if(number == 0)
+	{
+		std::cerr << "[ERROR] [ACTIVE SET SOLVER] set_num_steps(): "
+		          << "Input argument was 0 but it must be greater than zero." << std::endl;
+
+		return false;
+	}
+
+	this->maxSteps = number;
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,515 @@
+/**
+ * @file   FixedSizeQPSolver.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  An interior point QP solver for small problems whose size is known at compile time.
+ */
+
+#ifndef FIXEDSIZEQPSOLVER_H_
+#define FIXEDSIZEQPSOLVER_H_
+
+#include <algorithm>                                                                                // std::min
+#include <cmath>                                                                                    // std::isfinite, std::sqrt
+#include <Eigen/Dense>                                                                              // Eigen::Matrix, Eigen::Vector, and decompositions
+#include <iostream>                                                                                 // std::cerr
+#include <limits>                                                                                   // std::numeric_limits
+#include <stdexcept>                                                                                // std::invalid_argument, std::runtime_error
+#include <string>                                                                                   // std::to_string
+
+/**
+ * Solves problems of the form min 0.5*x'*H*x + x'*f subject to: xMin <= x <= xMax, B*x <= z,
+ * with the same interior point algorithm as QPSolver.
+ *
+ * The number of decision variables N and general constraints C are template arguments, so every
+ * matrix is a fixed-size Eigen type stored on the stack, and no call allocates on the heap. The
+ * Cholesky factorisation of the barrier Hessian is written out with loops bounded by N, so the
+ * compiler can unroll it completely. If rounding makes the barrier Hessian indefinite, the step
+ * falls back to Eigen's LDLT, like QPSolver. It is intended for small problems, like the control
+ * of a 6 or 7 joint arm with up to 20 constraints. For larger problems, use QPSolver.
+ *
+ * Example: FixedSizeQPSolver<7,1> solver; x = solver.solve(H, f, xMin, xMax, B, z, x0);
+ */
+template <int N, int C, class DataType = double>
+class FixedSizeQPSolver
+{
+	static_assert(N > 0,  "FixedSizeQPSolver needs at least one decision variable.");
+	static_assert(C >= 0, "FixedSizeQPSolver cannot have a negative number of constraints.");
+
+	public:
+
+		using Vector           = Eigen::Vector<DataType,N>;                                         ///< Nx1 decision variable
+		using Matrix           = Eigen::Matrix<DataType,N,N>;                                       ///< NxN Hessian
+		using ConstraintMatrix = Eigen::Matrix<DataType,C,N>;                                       ///< CxN general constraints
+		using ConstraintVector = Eigen::Vector<DataType,C>;                                         ///< Cx1 general constraints
+
+		/**
+		 * Empty constructor.
+		 */
+		FixedSizeQPSolver() {}
+
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: B*x <= z.
+		 * @param H A positive definite Hessian matrix (NxN).
+		 * @param f A vector (Nx1).
+		 * @param B The inequality constraint matrix (CxN).
+		 * @param z The inequality constraint vector (Cx1).
+		 * @param x0 A start point for the algorithm (Nx1).
+		 * @return The optimal solution for x.
+		 */
+		Vector
+		solve(const Matrix           &H,
+		      const Vector           &f,
+		      const ConstraintMatrix &B,
+		      const ConstraintVector &z,
+		      const Vector           &x0)
+		{
+			return solve(H, f, Vector::Constant(-std::numeric_limits<DataType>::infinity()),
+			                   Vector::Constant( std::numeric_limits<DataType>::infinity()), B, z, x0);
+		}
+
+		/**
+		 * Minimize 0.5*x'*H*x + x'*f subject to: xMin <= x <= xMax, B*x <= z.
+		 * The barrier for each bound only adds to one element of the gradient and the diagonal of the Hessian,
+		 * so B only needs the constraints that are not simple bounds.
+		 * @param H A positive definite Hessian matrix (NxN).
+		 * @param f A vector (Nx1).
+		 * @param xMin The lower bound (Nx1). Elements may be -infinity.
+		 * @param xMax The upper bound (Nx1). Elements may be +infinity.
+		 * @param B The inequality constraint matrix (CxN).
+		 * @param z The inequality constraint vector (Cx1).
+		 * @param x0 A start point for the algorithm (Nx1).
+		 * @return The optimal solution for x.
+		 */
+		Vector
+		solve(const Matrix           &H,
+		      const Vector           &f,
+		      const Vector           &xMin,
+		      const Vector           &xMax,
+		      const ConstraintMatrix &B,
+		      const ConstraintVector &z,
+		      const Vector           &x0);
+
+		/**
+		 * Set the tolerance for the step size in the interior point algorithm.
+		 * @param tolerance The algorithm terminates when the step is smaller than this.
+		 * @return Returns false if the input argument is invalid.
+		 */
+		bool
+		set_tolerance(const DataType &tolerance);
+
+		/**
+		 * Set the maximum number of steps in the interior point algorithm before terminating.
+		 * @param number As it says.
+		 * @return Returns false if the input argument is invalid.
+		 */
+		bool
+		set_max_steps(const unsigned int &number);
+
+		/**
+		 * Set the initial scalar for the constraint barriers in the interior point algorithm.
+		 * @param scalar A positive value.
+		 * @return Returns false if the input argument is invalid.
+		 */
+		bool
+		set_barrier_scalar(const DataType &scalar);
+
+		/**
+		 * Set the rate at which the constraint barriers are reduced on each step.
+		 * @param rate A value between 0 and 1.
+		 * @return Returns false if the input argument is invalid.
+		 */
+		bool
+		set_barrier_reduction_rate(const DataType &rate);
+
+		/**
+		 * @return The size of the final step in the interior point algorithm.
+		 */
+		DataType
+		step_size() const { return this->stepSize; }
+
+		/**
+		 * @return The number of steps the interior point algorithm took on the last call.
+		 */
+		unsigned int
+		num_steps() const { return this->numSteps; }
+
+		/**
+		 * @return The solution from the last call.
+		 */
+		Vector
+		last_solution() const { return this->lastSolution; }
+
+	private:
+
+		DataType tolerance = 1e-02;                                                                 ///< Terminate when the step is smaller than this
+
+		DataType stepSize = 0;                                                                      ///< Size of the final step
+
+		DataType barrierReductionRate = 1e-03;                                                      ///< Barrier scalar is multiplied by this every step
+
+		DataType initialBarrierScalar = 100;                                                        ///< Starting value of the barrier scalar
+
+		unsigned int maxSteps = 20;                                                                 ///< Maximum number of steps in the interior point algorithm
+
+		unsigned int numSteps = 0;                                                                  ///< Number of steps taken on the last call
+
+		Vector lastSolution = Vector::Zero();                                                       ///< As it says
+
+		/**
+		 * Solve A*x = b in place using the Cholesky factorisation A = L*L'.
+		 * Only the lower triangle of A is read, and it is overwritten with L.
+		 * @param A A positive definite matrix (NxN).
+		 * @param b The right-hand side on input, and the solution on output (Nx1).
+		 * @return False if A is not positive definite.
+		 */
+		static bool
+		cholesky_solve(Matrix &A, Vector &b);
+
+		/**
+		 * Find a point just inside all the constraints, using least squares on the stacked constraints.
+		 */
+		static Vector
+		find_interior_point(const Vector           &xMin,
+		                    const Vector           &xMax,
+		                    const ConstraintMatrix &B,
+		                    const ConstraintVector &z);
+
+};                                                                                                  // Semicolon needed after class declaration
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //      Solve a problem of the form: min 0.5*x'*H*x + x'*f s.t. xMin <= x <= xMax, B*x <= z       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+typename FixedSizeQPSolver<N,C,DataType>::Vector
+FixedSizeQPSolver<N,C,DataType>::solve(const Matrix           &H,
+                                       const Vector           &f,
+                                       const Vector           &xMin,
+                                       const Vector           &xMax,
+                                       const ConstraintMatrix &B,
+                                       const ConstraintVector &z,
+                                       const Vector           &x0)
+{
+	for(int k = 0; k < N; k++)
+	{
+		if(xMin(k) >= xMax(k))
+		{
+			throw std::invalid_argument("[ERROR] [FIXED SIZE QP SOLVER] solve(): "
+			                            "The lower bound for element " + std::to_string(k) + " is not less than "
+			                            "the upper bound (" + std::to_string(xMin(k)) + " >= " + std::to_string(xMax(k)) + ").");
+		}
+	}
+
+	// Lambda function for checking that a point is strictly inside all the constraints
+	auto is_interior = [&](const Vector &point) -> bool
+	{
+		for(int k = 0; k < N; k++)
+		{
+			if(point(k) <= xMin(k) or point(k) >= xMax(k)) return false;                            // Infinite bounds are never violated
+		}
+
+		if constexpr(C > 0)                                                                         // Rows of a 0xN matrix don't compile
+		{
+			for(int j = 0; j < C; j++)
+			{
+				if(z(j) - B.row(j).dot(point) <= 0) return false;
+			}
+		}
+
+		return true;
+	};
+
+	// Set the start point
+	Vector x = x0;
+
+	if(not is_interior(x))
+	{
+		// Move inside the bounds, a tiny offset from any that are violated
+		for(int k = 0; k < N; k++)
+		{
+			DataType offset = std::min(DataType(1e-03), DataType(0.5)*(xMax(k) - xMin(k)));
+
+			     if(x(k) <= xMin(k)) x(k) = xMin(k) + offset;
+			else if(x(k) >= xMax(k)) x(k) = xMax(k) - offset;
+		}
+
+		if(not is_interior(x)) x = find_interior_point(xMin, xMax, B, z);
+
+		if(not is_interior(x))
+		{
+			throw std::runtime_error("[ERROR] [FIXED SIZE QP SOLVER] solve(): "
+			                         "Unable to find a solution that satisfies constraints.");
+		}
+	}
+
+	// h = 0.5*x'*H*x + x'*f - u*sum log(d_i),   d_i = z_i - b_i'*x
+	// g = H*x + f + u*sum (1/d_i)*b_i
+	// I = H + u*sum (1/d_i^2)*b_i*b_i'
+
+	DataType u = this->initialBarrierScalar;
+	Matrix I;                                                                                       // Hessian of the barrier function
+	Vector g, dx;                                                                                   // Gradient, and Newton step
+	ConstraintVector d;                                                                             // Distance to every general constraint
+
+	for(unsigned int i = 0; i < this->maxSteps; i++)
+	{
+		this->numSteps = i+1;
+
+		g.noalias() = H*x + f;
+		I = H;
+
+		// Add the barrier for each bound to the gradient and the diagonal of the Hessian
+		for(int k = 0; k < N; k++)
+		{
+			if(std::isfinite(xMax(k)))
+			{
+				DataType dist = xMax(k) - x(k);                                                     // Distance to upper bound
+				if(dist <= 0) dist = 1e-03;                                                         // Constraint violated; set a small, but non-zero distance
+				g(k)   += u/dist;
+				I(k,k) += u/(dist*dist);
+			}
+
+			if(std::isfinite(xMin(k)))
+			{
+				DataType dist = x(k) - xMin(k);                                                     // Distance to lower bound
+				if(dist <= 0) dist = 1e-03;
+				g(k)   -= u/dist;
+				I(k,k) += u/(dist*dist);
+			}
+		}
+
+		// Add the barrier for each general constraint; only the lower triangle of I is needed
+		if constexpr(C > 0)
+		{
+			for(int j = 0; j < C; j++)
+			{
+				d(j) = z(j) - B.row(j).dot(x);
+
+				if(d(j) <= 0) d(j) = 1e-03;                                                         // Constraint violated; set a small, but non-zero distance
+
+				DataType weight = u/(d(j)*d(j));
+
+				g += (u/d(j))*B.row(j).transpose();
+
+				for(int col = 0; col < N; col++)
+				{
+					for(int row = col; row < N; row++) I(row,col) += weight*B(j,row)*B(j,col);
+				}
+			}
+		}
+
+		dx = -g;
+
+		Matrix hessian = I;                                                                         // cholesky_solve() overwrites I
+
+		if(not cholesky_solve(I, dx))
+		{
+			// Rounding can make I indefinite when the barrier is tiny next to H,
+			// so carry on with a pivoting LDLT like QPSolver does
+			dx = -g;
+			Eigen::LDLT<Matrix> decomposition(hessian);                                             // Only reads the lower triangle
+			decomposition.solveInPlace(dx);
+		}
+
+		if(not dx.allFinite())
+		{
+			throw std::runtime_error("[ERROR] [FIXED SIZE QP SOLVER] solve(): "
+			                         "The Newton step was not finite on step " + std::to_string(i+1) + ". "
+			                         "The Hessian matrix may not be positive definite.");
+		}
+
+		// Scale the step so that no constraint is violated
+		DataType alpha = 1.0;
+		for(int k = 0; k < N; k++)
+		{
+			if(x(k) + dx(k) >= xMax(k)) alpha = std::min(alpha, DataType(0.9)*(xMax(k) - x(k))/dx(k));
+			if(x(k) + dx(k) <= xMin(k)) alpha = std::min(alpha, DataType(0.9)*(xMin(k) - x(k))/dx(k));
+		}
+
+		if constexpr(C > 0)
+		{
+			for(int j = 0; j < C; j++)
+			{
+				DataType dotProd = B.row(j).dot(dx);
+
+				if(d(j) - dotProd <= 0) alpha = std::min(alpha, DataType(0.9)*d(j)/dotProd);
+			}
+		}
+
+		dx *= alpha;
+
+		this->stepSize = dx.norm();
+
+		if(this->stepSize <= this->tolerance) break;
+
+		x += dx;
+		u *= this->barrierReductionRate;
+	}
+
+	this->lastSolution = x;
+
+	return x;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Solve A*x = b in place with the Cholesky factorisation                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+bool
+FixedSizeQPSolver<N,C,DataType>::cholesky_solve(Matrix &A, Vector &b)
+{
+	// Factorise A = L*L', column by column
+	for(int j = 0; j < N; j++)
+	{
+		DataType diagonal = A(j,j);
+		for(int k = 0; k < j; k++) diagonal -= A(j,k)*A(j,k);
+
+		if(diagonal <= 0) return false;
+
+		A(j,j) = std::sqrt(diagonal);
+
+		for(int i = j+1; i < N; i++)
+		{
+			DataType sum = A(i,j);
+			for(int k = 0; k < j; k++) sum -= A(i,k)*A(j,k);
+			A(i,j) = sum / A(j,j);
+		}
+	}
+
+	// Forward substitution: L*y = b
+	for(int i = 0; i < N; i++)
+	{
+		for(int k = 0; k < i; k++) b(i) -= A(i,k)*b(k);
+		b(i) /= A(i,i);
+	}
+
+	// Backward substitution: L'*x = y
+	for(int i = N-1; i >= 0; i--)
+	{
+		for(int k = i+1; k < N; k++) b(i) -= A(k,i)*b(k);
+		b(i) /= A(i,i);
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Find a point just inside the bounds and the general constraints                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+typename FixedSizeQPSolver<N,C,DataType>::Vector
+FixedSizeQPSolver<N,C,DataType>::find_interior_point(const Vector           &xMin,
+                                                     const Vector           &xMax,
+                                                     const ConstraintMatrix &B,
+                                                     const ConstraintVector &z)
+{
+	// Write the finite bounds as rows of the constraint matrix. The maximum size is known,
+	// so these are still stored on the stack.
+	Eigen::Matrix<DataType,Eigen::Dynamic,N,Eigen::ColMajor,2*N+C,N> allB(2*N+C,N);
+	Eigen::Matrix<DataType,Eigen::Dynamic,1,Eigen::ColMajor,2*N+C,1> allZ(2*N+C);
+	allB.setZero();
+
+	int numRows = 0;
+	for(int k = 0; k < N; k++)
+	{
+		if(std::isfinite(xMax(k))) { allB(numRows,k) =  1; allZ(numRows) =  xMax(k); numRows++; }
+		if(std::isfinite(xMin(k))) { allB(numRows,k) = -1; allZ(numRows) = -xMin(k); numRows++; }
+	}
+
+	allB.middleRows(numRows,C) = B;
+	allZ.segment(numRows,C)    = z;
+	numRows += C;
+
+	allB.conservativeResize(numRows,N);
+	allZ.conservativeResize(numRows);
+	allZ.array() -= 1e-03;                                                                          // Add a tiny offset so we're not exactly on the constraint
+
+	if(numRows >= N) return (allB.transpose()*allB).ldlt().solve(allB.transpose()*allZ);            // Least squares
+	else
+	{
+		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic,Eigen::ColMajor,N,N> BBt = allB*allB.transpose();
+
+		return allB.transpose()*BBt.ldlt().solve(allZ);                                             // Minimum norm
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Set the tolerance on the step size in the interior point algorithm               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+bool
+FixedSizeQPSolver<N,C,DataType>::set_tolerance(const DataType &tolerance)
+{
+	if(tolerance <= 0)
+	{
+		std::cerr << "[ERROR] [FIXED SIZE QP SOLVER] set_tolerance(): "
+		          << "Input argument was " << tolerance << " but it must be positive." << std::endl;
+
+		return false;
+	}
+
+	this->tolerance = tolerance;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Set the maximum number of steps in the interior point algorithm                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+bool
+FixedSizeQPSolver<N,C,DataType>::set_max_steps(const unsigned int &number)
+{
+	if(number == 0)
+	{
+		std::cerr << "[ERROR] [FIXED SIZE QP SOLVER] set_max_steps(): "
+		          << "Input argument was 0 but it must be greater than zero." << std::endl;
+
+		return false;
+	}
+
+	this->maxSteps = number;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Set the initial scalar on the constraint barriers                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+bool
+FixedSizeQPSolver<N,C,DataType>::set_barrier_scalar(const DataType &scalar)
+{
+	if(scalar <= 0)
+	{
+		std::cerr << "[ERROR] [FIXED SIZE QP SOLVER] set_barrier_scalar(): "
+		          << "Input argument was " << scalar << " but it must be positive." << std::endl;
+
+		return false;
+	}
+
+	this->initialBarrierScalar = scalar;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Set the rate at which the barrier scalar is reduced each step                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int N, int C, class DataType> inline
+bool
+FixedSizeQPSolver<N,C,DataType>::set_barrier_reduction_rate(const DataType &rate)
+{
+	if(rate <= 0 or rate >= 1)
+	{
+		std::cerr << "[ERROR] [FIXED SIZE QP SOLVER] set_barrier_reduction_rate(): "
+		          << "Input argument was " << rate << " but it must be between 0 and 1." << std::endl;
+
+		return false;
+	}
+
+	this->barrierReductionRate = rate;
+
+	return true;
+}
+
+#endif
@@ -13,10 +13,149 @@
 #ifndef QPSOLVER_H_
 #define QPSOLVER_H_
 
+#include <cmath>                                                                                    // std::pow
 #include <Eigen/Dense>                                                                              // Linear algebra and matrix decomposition
 #include <iostream>                                                                                 // cerr, cout
+#include <limits>                                                                                   // numeric_limits
 #include <vector>                                                                                   // vector
 
+/**
+ * Memory for the QPSolver class. It is only resized when the dimensions of the problem change,
+ * so repeated calls on a problem of the same size do not allocate on the heap.
+ */
+template <class DataType>
+struct QPWorkspace
+{
+	unsigned int numAllocations = 0;                                                          ///< Number of times the memory was resized
+	
+	// Used in the interior point algorithm
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> I;                                  ///< Hessian of the barrier function
+	Eigen::Vector<DataType,Eigen::Dynamic> g;                                                 ///< Gradient of the barrier function
+	Eigen::Vector<DataType,Eigen::Dynamic> d;                                                 ///< Distance to every general constraint
+	Eigen::Vector<DataType,Eigen::Dynamic> x;                                                 ///< The decision variable
+	Eigen::Vector<DataType,Eigen::Dynamic> dx;                                                ///< Newton step
+	Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> decomposition;         ///< Factorisation of the Hessian
+	
+	// Used to find a start point inside the constraints, when the given one is not
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> allB;                               ///< Finite bounds and general constraints as rows
+	Eigen::Vector<DataType,Eigen::Dynamic> allZ;                                              ///< Limits for allB, less a tiny offset
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> allBBt;                             ///< allB*allB'
+	Eigen::Vector<DataType,Eigen::Dynamic> allLambda;                                         ///< (allB*allB')^-1*allZ
+	Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> allDecomposition;      ///< Factorisation of allB*allB'
+	
+	// Used to convert redundant least squares to standard form
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> H;                                  ///< [ 0 -A ; -A' W ]
+	Eigen::Vector<DataType,Eigen::Dynamic> f;                                                 ///< [ y ; -W*xd ]
+	Eigen::Vector<DataType,Eigen::Dynamic> x0;                                                ///< [ lambda ; x0 ]
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> B;                                  ///< [ 0 B ]
+	Eigen::Vector<DataType,Eigen::Dynamic> xMin;                                              ///< [ -inf ; xMin ]
+	Eigen::Vector<DataType,Eigen::Dynamic> xMax;                                              ///< [ +inf ; xMax ]
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> invWAt;                             ///< W^-1*A'
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> AinvWAt;                            ///< A*W^-1*A'
+	Eigen::Vector<DataType,Eigen::Dynamic> residual;                                          ///< y - A*xd
+	Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> weightDecomposition;   ///< Factorisation of W
+	Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> dualDecomposition;     ///< Factorisation of A*W^-1*A'
+	Eigen::Vector<DataType,Eigen::Dynamic> xr;                                                ///< Range space part of the dual method solution
+	Eigen::Vector<DataType,Eigen::Dynamic> xn;                                                ///< Null space part of the dual method solution
+	
+	// Used when a problem is given without bounds
+	Eigen::Vector<DataType,Eigen::Dynamic> noLowerBound;                                      ///< -inf
+	Eigen::Vector<DataType,Eigen::Dynamic> noUpperBound;                                      ///< +inf
+	
+	/**
+	 * Resize the memory for the interior point algorithm, if the dimensions have changed.
+	 * @param dim Dimensions of the decision variable.
+	 * @param numConstraints Number of general inequality constraints.
+	 * @param numBounds Number of finite upper and lower bounds.
+	 */
+	void resize_interior_point(const unsigned int &dim, const unsigned int &numConstraints, const unsigned int &numBounds)
+	{
+		unsigned int numRows = numBounds + numConstraints;
+		
+		if(this->x.size() == dim and this->d.size() == numConstraints and this->allZ.size() == numRows) return;
+		
+		this->I.resize(dim,dim);
+		this->g.resize(dim);
+		this->d.resize(numConstraints);
+		this->x.resize(dim);
+		this->dx.resize(dim);
+		this->decomposition = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(dim);
+		
+		this->allB.resize(numRows,dim);
+		this->allZ.resize(numRows);
+		this->allBBt.resize(numRows,numRows);
+		this->allLambda.resize(numRows);
+		this->allDecomposition = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(numRows);
+		
+		this->numAllocations++;
+	}
+	
+	/**
+	 * Resize the memory for converting a redundant least squares problem, if the dimensions have changed.
+	 * @param n Dimensions of the decision variable.
+	 * @param m Number of equality constraints.
+	 * @param c Number of general inequality constraints.
+	 */
+	void resize_least_squares(const unsigned int &n, const unsigned int &m, const unsigned int &c)
+	{
+		if(this->invWAt.rows() == n and this->invWAt.cols() == m and this->B.rows() == c and this->H.rows() == m+n) return;
+		
+		this->H.resize(m+n,m+n);
+		this->f.resize(m+n);
+		this->x0.resize(m+n);
+		this->B.resize(c,m+n);
+		this->xMin.resize(m+n);
+		this->xMax.resize(m+n);
+		this->invWAt.resize(n,m);
+		this->AinvWAt.resize(m,m);
+		this->residual.resize(m);
+		this->weightDecomposition = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(n);
+		this->dualDecomposition   = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(m);
+		
+		// These parts never change
+		this->H.block(0,0,m,m).setZero();
+		this->B.block(0,0,c,m).setZero();
+		this->xMin.head(m).setConstant(-std::numeric_limits<DataType>::infinity());
+		this->xMax.head(m).setConstant( std::numeric_limits<DataType>::infinity());
+		
+		this->numAllocations++;
+	}
+	
+	/**
+	 * Resize the memory for the dual method, if the dimensions have changed.
+	 * @param n Dimensions of the decision variable.
+	 * @param m Number of equality constraints.
+	 */
+	void resize_dual(const unsigned int &n, const unsigned int &m)
+	{
+		if(this->invWAt.rows() == n and this->invWAt.cols() == m and this->xr.size() == n) return;
+		
+		this->invWAt.resize(n,m);
+		this->AinvWAt.resize(m,m);
+		this->residual.resize(m);
+		this->xr.resize(n);
+		this->xn.resize(n);
+		this->weightDecomposition = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(n);
+		this->dualDecomposition   = Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>>(m);
+		
+		this->numAllocations++;
+	}
+	
+	/**
+	 * Resize the infinite bounds, if the dimensions have changed.
+	 * @param dim Dimensions of the decision variable.
+	 */
+	void resize_no_bounds(const unsigned int &dim)
+	{
+		if(this->noLowerBound.size() == dim) return;
+		
+		this->noLowerBound.setConstant(dim,-std::numeric_limits<DataType>::infinity());
+		this->noUpperBound.setConstant(dim, std::numeric_limits<DataType>::infinity());
+		
+		this->numAllocations++;
+	}
+};
+
 template <class DataType = float>
 class QPSolver
 {
@@ -76,7 +215,7 @@ class QPSolver
 		 * @param x0 A start point for the algorithm.
 		 * @return The optimal solution within the constraints.
 		 */
-		Eigen::Vector<DataType, Eigen::Dynamic>
+		const Eigen::Vector<DataType, Eigen::Dynamic>&
 		constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &y,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
@@ -99,7 +238,7 @@ class QPSolver
 		 * @param xMax upper bound on the solution.
 		 * @param x0 Starting point for the algorithm.
 		 */                  
-		Eigen::Vector<DataType, Eigen::Dynamic>
+		const Eigen::Vector<DataType, Eigen::Dynamic>&
 		constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
@@ -123,7 +262,7 @@ class QPSolver
 		 * @param z Inequality constraint vector.
 		 * @param x0 Starting point for the algorithm.
 		 */  
-		Eigen::Vector<DataType, Eigen::Dynamic>
+		const Eigen::Vector<DataType, Eigen::Dynamic>&
 		constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
 		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
@@ -132,6 +271,37 @@ class QPSolver
 		                          const Eigen::Vector<DataType, Eigen::Dynamic> &z,
 		                          const Eigen::Vector<DataType, Eigen::Dynamic> &x0);
 		
+		/**
+		 * Solve a redundant least squares problem with bounds and inequality constraints on the solution.
+		 * The problem is of the form:
+		 * min 0.5*(xd - x)'*W*(xd - x)
+		 * subject to: A*x = y
+		 *             xMin <= x <= xMax
+		 *             B*x < z
+		 * The bounds are applied element-wise, so B only needs the rows that are not simple bounds.
+		 * It uses an interior point algorithm and thus requires a start point as an argument.
+		 * With the primal method, repeated calls on a problem of the same size do not allocate on the heap.
+		 * @param xd Desired value for the solution.
+		 * @param W Weighting on the desired value / solution.
+		 * @param A Equality constraint matrix.
+		 * @param y Equality constraint vector.
+		 * @param xMin Lower bound on the solution. Elements may be -infinity.
+		 * @param xMax Upper bound on the solution. Elements may be +infinity.
+		 * @param B Inequality constraint matrix. It may have zero rows.
+		 * @param z Inequality constraint vector.
+		 * @param x0 Starting point for the algorithm.
+		 */  
+		const Eigen::Vector<DataType, Eigen::Dynamic>&
+		constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
+		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
+		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
+		                          const Eigen::Vector<DataType, Eigen::Dynamic> &y,
+		                          const Eigen::Vector<DataType, Eigen::Dynamic> &xMin,
+		                          const Eigen::Vector<DataType, Eigen::Dynamic> &xMax,
+		                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+		                          const Eigen::Vector<DataType, Eigen::Dynamic> &z,
+		                          const Eigen::Vector<DataType, Eigen::Dynamic> &x0);
+		
 		/**
 		 * Solve a generic quadratic programming problem with inequality constraints.
 		 * The problem is of the form:
@@ -145,9 +315,38 @@ class QPSolver
 		 * @param x0 Start point for the algorithm.
 		 * @return x: A solution that minimizes the problem whilst obeying inequality constraints.
 		 */
-		Eigen::Vector<DataType, Eigen::Dynamic>  
+		const Eigen::Vector<DataType, Eigen::Dynamic>&  
+		solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
+		      const Eigen::Vector<DataType, Eigen::Dynamic> &f,
+		      const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+		      const Eigen::Vector<DataType, Eigen::Dynamic> &z,
+		      const Eigen::Vector<DataType, Eigen::Dynamic> &x0);
+		
+		/**
+		 * Solve a generic quadratic programming problem with bounds and inequality constraints.
+		 * The problem is of the form:
+		 * min 0.5*x'*H*x + x'*f
+		 * subject to: xMin <= x <= xMax
+		 *             B*x < z
+		 * The barrier for each bound only touches one element of the gradient and the diagonal of
+		 * the Hessian, so it is much cheaper than writing the bounds as rows of B.
+		 * This method uses an interior point algorithm and thus requires a start point as an argument.
+		 * Repeated calls on a problem of the same size do not allocate on the heap.
+		 * @param H A positive semi-definite matrix such that H = H'.
+		 * @param f A vector for the linear component of the problem.
+		 * @param xMin Lower bound on the decision variable. Elements may be -infinity.
+		 * @param xMax Upper bound on the decision variable. Elements may be +infinity.
+		 * @param B Inequality constraint matrix. It may have zero rows.
+		 * @param z Inequality constraint vector.
+		 * @param x0 Start point for the algorithm.
+		 * @return x: A solution that minimizes the problem whilst obeying the constraints.
+		 *         It refers to last_solution(), so it is overwritten on the next call.
+		 */
+		const Eigen::Vector<DataType, Eigen::Dynamic>&  
 		solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
 		      const Eigen::Vector<DataType, Eigen::Dynamic> &f,
+		      const Eigen::Vector<DataType, Eigen::Dynamic> &xMin,
+		      const Eigen::Vector<DataType, Eigen::Dynamic> &xMax,
 		      const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
 		      const Eigen::Vector<DataType, Eigen::Dynamic> &z,
 		      const Eigen::Vector<DataType, Eigen::Dynamic> &x0);
@@ -193,15 +392,34 @@ class QPSolver
 		 */
 		unsigned int num_steps() const { return this->numSteps; }
 		
+		/**
+		 * @return True if use_warm_start() was called.
+		 */
+		bool warm_start_enabled() const { return this->start == warm; }
+		
+		/**
+		 * @return True if the last call resumed from where the call before it finished.
+		 */
+		bool was_warm_started() const { return this->warmStarted; }
+		
 		/**
 		 * @return Returns the last solution from when the interior point algorithm was previously called.
+		 *         It refers to the solver's memory, so it is overwritten on the next call.
+		 */
+		const Eigen::Vector<DataType, Eigen::Dynamic>& last_solution() const { return this->lastSolution; }
+		
+		/**
+		 * @return The number of times the internal memory was resized. It only grows when the
+		 *         dimensions of the problem change. It does not count temporaries, so build with
+		 *         EIGEN_RUNTIME_NO_MALLOC to check that repeated calls do not allocate on the heap.
 		 */
-		Eigen::Vector<DataType, Eigen::Dynamic> last_solution() const { return this->lastSolution; }
+		unsigned int workspace_allocations() const { return this->workspace.numAllocations; }
 		
 		/**
 		 * Clears the last solution such that last_solution().size() == 0.
+		 * The next call will not be warm started.
 		 */
-		void clear_last_solution() { this->lastSolution.resize(0); }
+		void clear_last_solution() { this->lastSolution.resize(0); this->lastInteriorPoint.resize(0); }
 		
 		/**
 		 * The interior point algorithm will use the dual method to solve a redundant QP problem.
@@ -213,6 +431,20 @@ class QPSolver
 		 */
 		void use_primal();
 		
+		/**
+		 * When the start point x0 is last_solution(), the interior point algorithm will resume from where
+		 * it finished on the previous call, including the barrier scalar and any Lagrange multipliers.
+		 * For problems that change a little between calls, e.g. in a control loop, it then converges in a
+		 * few steps. Any other start point is used as given, as is the last solution if it does not
+		 * satisfy the new constraints, or the problem has changed size.
+		 */
+		void use_warm_start();
+		
+		/**
+		 * The interior point algorithm will start from the given start point and the initial barrier scalar.
+		 */
+		void use_cold_start();
+		
 	private:
 		
 		DataType tol = 1e-02;                                                                     ///< Minimum value for the step size before terminating the interior point algorithm.
@@ -222,12 +454,34 @@ class QPSolver
 		
 		enum Method {dual, primal} method = primal;                                               ///< Used to select which method to solve for with redundant least squares problems.                                               
 		
+		enum Start {cold, warm} start = cold;                                                     ///< Used to select the start point for the interior point algorithm.
+		
+		bool warmStarted = false;                                                                 ///< Whether the last call to the interior point algorithm was warm started.
+		
+		DataType lastBarrierScalar = 0;                                                           ///< Barrier scalar on the final step of the interior point algorithm.
+		
+		Eigen::Vector<DataType, Eigen::Dynamic> lastInteriorPoint;                                ///< Final point of the interior point algorithm, including any Lagrange multipliers.
+		
 		unsigned int maxSteps = 20;                                                               ///< Maximum number of iterations to run interior point method before terminating.
 		
 		unsigned int numSteps = 0;                                                                ///< Records the number of steps it took to solve a problem with the interior point algorithm.
 		
 		Eigen::Vector<DataType, Eigen::Dynamic> lastSolution;                                     ///< Final solution returned by interior point algorithm. Can be used as a starting point for future calls to the method.
 		
+		QPWorkspace<DataType> workspace;                                                          ///< Memory reused between calls
+		
+		/**
+		 * Run the interior point algorithm on min 0.5*x'*H*x + x'*f subject to: xMin <= x <= xMax, B*x <= z.
+		 * The arguments are assumed to be sound. The solution is left in workspace.x.
+		 */
+		void interior_point(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
+		                    const Eigen::Vector<DataType, Eigen::Dynamic> &f,
+		                    const Eigen::Vector<DataType, Eigen::Dynamic> &xMin,
+		                    const Eigen::Vector<DataType, Eigen::Dynamic> &xMax,
+		                    const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+		                    const Eigen::Vector<DataType, Eigen::Dynamic> &z,
+		                    const Eigen::Vector<DataType, Eigen::Dynamic> &x0);
+		
 		/**
 		 * The std::min function doesn't like floats, so I had to write my own ಠ_ಠ
 		 * @return Returns the minimum between to values 'a' and 'b'.
@@ -347,7 +601,7 @@ QPSolver<DataType>::redundant_least_squares(const Eigen::Vector<DataType, Eigen:
  //      Solve a constrained problem: min 0.5*(y - A*x)'*W*(y - A*x) s.t. xMin <= x <= xMax        //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 template <class DataType> inline
-Eigen::Vector<DataType,Eigen::Dynamic>
+const Eigen::Vector<DataType,Eigen::Dynamic>&
 QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic>           &y,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>  &A,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>  &W,
@@ -384,27 +638,18 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
 	
 	unsigned int n = x0.size();
 	
-	// B = [  I ] < z = [  xMax ]
-	//     [ -I ]       [ -xMin ]
-	
-	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> B(2*n,n);
-	B.block(0,0,n,n).setIdentity();
-	B.block(n,0,n,n) = -Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>::Identity(n,n);
-	
-	Eigen::Vector<DataType,Eigen::Dynamic> z(2*n);
-	z.head(n) =  xMax;
-	z.tail(n) = -xMin;
-	
 	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> AtW = A.transpose()*W;                   // Makes calcs a tiny bit faster
 
-	return solve(AtW*A, -AtW*y, B, z, x0);                                                         // Send to interior point algorithm and solve
+	return solve(AtW*A, -AtW*y, xMin, xMax,
+	             Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>(0,n),                       // No other constraints
+	             Eigen::Vector<DataType,Eigen::Dynamic>(0), x0);                                   // Send to interior point algorithm and solve
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //    Solve a constrained problem min 0.5*(xd - x)'*W*(xd - x) s.t. A*x = y, xMin <= x <= xMax    //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 template <class DataType> inline
-Eigen::Vector<DataType,Eigen::Dynamic>
+const Eigen::Vector<DataType,Eigen::Dynamic>&
 QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
@@ -421,29 +666,20 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
 		                            "the xMax argument had " + std::to_string(xMax.size()) + " elements.");
 	}
 		                       
-	// Convert constraints to standard form and pass on to generic function
+	// Pass on to generic function with no other inequality constraints
 	
 	unsigned int n = xMin.size();
 	
-	// B = [  I ] < z = [  xMax ]
-	//     [ -I ]     = [ -xMin ]
-	
-	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> B(2*n,n);
-	B.block(0,0,n,n).setIdentity();
-	B.block(n,0,n,n) = -Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>::Identity(n,n);
-	
-	Eigen::Vector<DataType,Eigen::Dynamic> z(2*n);
-	z.head(n) =  xMax;
-	z.tail(n) = -xMin;
-	
-	return constrained_least_squares(xd, W, A, y, B, z, x0);
+	return constrained_least_squares(xd, W, A, y, xMin, xMax,
+	                                 Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>(0,n),
+	                                 Eigen::Vector<DataType,Eigen::Dynamic>(0), x0);
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //        Solve a constrained problem min 0.5*(xd - x)'*W*(xd - x) s.t. A*x = y, B*x < z          //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 template <class DataType> inline
-Eigen::Vector<DataType,Eigen::Dynamic>
+const Eigen::Vector<DataType,Eigen::Dynamic>&
 QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
@@ -451,6 +687,26 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
                                               const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
                                               const Eigen::Vector<DataType, Eigen::Dynamic> &z,
                                               const Eigen::Vector<DataType, Eigen::Dynamic> &x0)
+{
+	this->workspace.resize_no_bounds(xd.size());
+	
+	return constrained_least_squares(xd, W, A, y, this->workspace.noLowerBound, this->workspace.noUpperBound, B, z, x0);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //  Solve min 0.5*(xd - x)'*W*(xd - x) s.t. A*x = y, xMin <= x <= xMax, B*x < z                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+const Eigen::Vector<DataType,Eigen::Dynamic>&
+QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eigen::Dynamic> &xd,
+                                              const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &W,
+                                              const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &A,
+                                              const Eigen::Vector<DataType, Eigen::Dynamic> &y,
+                                              const Eigen::Vector<DataType, Eigen::Dynamic> &xMin,
+                                              const Eigen::Vector<DataType, Eigen::Dynamic> &xMax,
+                                              const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+                                              const Eigen::Vector<DataType, Eigen::Dynamic> &z,
+                                              const Eigen::Vector<DataType, Eigen::Dynamic> &x0)
 {
 	// Ensure input arguments are sound
 	if(xd.size() != W.rows() or W.rows() != A.cols() or A.cols() != B.cols() or B.cols() != x0.size())
@@ -476,6 +732,14 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
 		                            "The equality constraint matrix A had " + std::to_string(A.rows()) + " rows, and "
 		                            "the equality constraint vector y had " + std::to_string(y.size()) + " elements.");
 	}
+	else if(xMin.size() != xd.size() or xMax.size() != xd.size())
+	{
+		throw std::invalid_argument("[ERROR] [QP SOLVER] constrained_least_squares(): "
+		                            "Dimensions for the bounds do not match. "
+		                            "The desired value xd had " + std::to_string(xd.size()) + " elements, "
+		                            "the lower bound had " + std::to_string(xMin.size()) + " elements, and "
+		                            "the upper bound had " + std::to_string(xMax.size()) + " elements.");
+	}
 	else if(B.rows() != z.rows())
 	{
 		throw std::invalid_argument("[ERROR] [QP SOLVER] constrained_least_squared(): "
@@ -490,65 +754,107 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
 		unsigned int m = A.rows();                                                                // Number of equality constraints
 		unsigned int n = A.cols();                                                                // Decision variable
 		
+		QPWorkspace<DataType> &ws = this->workspace;                                              // Makes referencing easier
+		
+		ws.resize_least_squares(n,m,c);                                                           // Only if the dimensions changed
+		
 		// H = [  0  -A ]
 		//     [ -A'  W ]
-		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> H(m+n,m+n);
-		H.block(0,0,m,m).setZero();
-		H.block(0,m,m,n) = -A;
-		H.block(m,0,n,m) = -A.transpose();
-		H.block(m,m,n,n) = W;
+		ws.H.block(0,m,m,n) = -A;
+		ws.H.block(m,0,n,m) = -A.transpose();
+		ws.H.block(m,m,n,n) = W;
 		
 		// f = [    y  ]
 		//     [ -W*xd ]
-		Eigen::Vector<DataType,Eigen::Dynamic> f(m+n);
-		f.head(m) = y;
-		f.tail(n) = -W*xd;
+		ws.f.head(m) = y;
+		ws.f.tail(n).setZero();
+		ws.f.tail(n).noalias() -= W*xd;
+		
+		// x0 = [ lambda ]
+		//      [   x0   ]
+		ws.weightDecomposition.compute(W);
+		ws.invWAt = A.transpose();
+		ws.weightDecomposition.solveInPlace(ws.invWAt);                                           // W^-1*A'
+		ws.AinvWAt.noalias() = A*ws.invWAt;
+		ws.dualDecomposition.compute(ws.AinvWAt);
+		ws.residual = y;
+		ws.residual.noalias() -= A*xd;
+		ws.dualDecomposition.solveInPlace(ws.residual);
+		ws.x0.head(m) = ws.residual;                                                              // Initial guess for Lagrange multipliers
+		ws.x0.tail(n) = x0;
 		
-		// new_x0 = [ lambda ]
-		//          [   x0   ]
-		Eigen::Vector<DataType,Eigen::Dynamic> new_x0(m+n);
-		new_x0.head(m) = (A*W.ldlt().solve(A.transpose())).ldlt().solve(y - A*xd);                // Initial guess for Lagrange multipliers
-		new_x0.tail(n) = x0;
+		// B = [ 0 B ]
+		ws.B.block(0,m,c,n) = B;
 		
-		// newB = [ 0 B ]
-		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> newB(c,m+n);
-		newB.block(0,0,c,m).setZero();
-		newB.block(0,m,c,n) = B;
+		// The Lagrange multipliers are unbounded
+		ws.xMin.tail(n) = xMin;
+		ws.xMax.tail(n) = xMax;
 		
-		this->lastSolution = solve(H,f,newB,z,new_x0).tail(n);                                    // We don't need the Lagrange multipliers
+		interior_point(ws.H, ws.f, ws.xMin, ws.xMax, ws.B, z, ws.x0);
+		
+		this->lastSolution = ws.x.tail(n);                                                        // We don't need the Lagrange multipliers
 		
 		return this->lastSolution;                                                                // Return decision variable x
 	}
 	else if(this->method == dual)
 	{
+		unsigned int n = xd.size();
+		
+		QPWorkspace<DataType> &ws = this->workspace;                                              // Makes referencing easier
+		
+		ws.resize_dual(n, A.rows());                                                              // Only if the dimensions changed
+		
 		// x = xd + W^-1*A'*lambda
 		
 		// lambda = (A*W^-1*A')^-1*(y - A*xd)
 		
-		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> invWAt = W.ldlt().solve(A.transpose()); // Makes calcs a little easier
+		ws.weightDecomposition.compute(W);
+		ws.invWAt = A.transpose();
+		ws.weightDecomposition.solveInPlace(ws.invWAt);                                           // W^-1*A'
+		ws.AinvWAt.noalias() = A*ws.invWAt;                                                       // Hessian matrix for dual problem
+		ws.dualDecomposition.compute(ws.AinvWAt);                                                 // Saves a bit of time
 		
-		Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> H = A*invWAt;                       // Hessian matrix for dual problem
+		Eigen::Vector<DataType,Eigen::Dynamic> &xr = ws.xr;
+		Eigen::Vector<DataType,Eigen::Dynamic> &xn = ws.xn;
 		
-		Eigen::LDLT<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> Hdecomp(H);                                  // Saves a bit of time
+		ws.residual = y;
+		ws.dualDecomposition.solveInPlace(ws.residual);
+		xr.noalias() = ws.invWAt*ws.residual;                                                     // Solve the range space
 		
-		Eigen::Vector<DataType,Eigen::Dynamic> xr = invWAt*(H,-y,B*invWAt,z,Hdecomp.solve(y));    // Solve the range space
-		
-		Eigen::Vector<DataType,Eigen::Dynamic> xn = xd - invWAt*Hdecomp.solve(A*xd);              // Compute null space component
+		ws.residual.noalias() = A*xd;
+		ws.dualDecomposition.solveInPlace(ws.residual);
+		xn = xd;
+		xn.noalias() -= ws.invWAt*ws.residual;                                                    // Compute null space component
 		
+		// Scale the null space step against every constraint b'*x <= z, where
+		// a = b'*xr, b = b'*xn, and dist = z - a - b
 		DataType alpha = 1.0;
-		for(int i = 0; i < z.size(); i++)
+		auto scale_step = [&](const DataType &a, const DataType &b, const DataType &dist)
+		{
+			if(dist <= 0) alpha = min(alpha, 0.99*abs((dist - a)/b));
+		};
+		
+		// A bound has b = +/- e_j, so it only needs one element of xr and xn
+		for(unsigned int j = 0; j < n; j++)
+		{
+			if(std::isfinite(xMax(j))) scale_step( xr(j),  xn(j),  xMax(j) - xr(j) - xn(j));
+			if(std::isfinite(xMin(j))) scale_step(-xr(j), -xn(j), -xMin(j) + xr(j) + xn(j));
+		}
+		
+		for(Eigen::Index i = 0; i < B.rows(); i++)
 		{
 			DataType a = B.row(i).dot(xr);
 			
 			DataType b = B.row(i).dot(xn);
 			
-			DataType dist = z(i) - a - b;
-			
-			if(dist <= 0) alpha = min(alpha, 0.99*abs((dist - a)/b));
+			scale_step(a, b, z(i) - a - b);
 		}
 		
 		this->lastSolution = xr + alpha*xn;
 		
+		this->lastInteriorPoint.resize(0);                                                        // Not solved with the interior point algorithm
+		this->warmStarted = false;
+		
 		return this->lastSolution;
 	}
 	else
@@ -563,12 +869,30 @@ QPSolver<DataType>::constrained_least_squares(const Eigen::Vector<DataType, Eige
  //          Solve a problem of the form: min 0.5*x'*H*x + x'*f subject to: B*x <= z              //        
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 template <class DataType> inline
-Eigen::Vector<DataType,Eigen::Dynamic>
+const Eigen::Vector<DataType,Eigen::Dynamic>&
 QPSolver<DataType>::solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
                           const Eigen::Vector<DataType,Eigen::Dynamic> &f,
                           const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
                           const Eigen::Vector<DataType,Eigen::Dynamic> &z,
                           const Eigen::Vector<DataType,Eigen::Dynamic> &x0)
+{
+	this->workspace.resize_no_bounds(x0.size());
+	
+	return solve(H, f, this->workspace.noLowerBound, this->workspace.noUpperBound, B, z, x0);
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //    Solve a problem of the form: min 0.5*x'*H*x + x'*f s.t. xMin <= x <= xMax, B*x <= z        //        
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+const Eigen::Vector<DataType,Eigen::Dynamic>&
+QPSolver<DataType>::solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
+                          const Eigen::Vector<DataType,Eigen::Dynamic> &f,
+                          const Eigen::Vector<DataType,Eigen::Dynamic> &xMin,
+                          const Eigen::Vector<DataType,Eigen::Dynamic> &xMax,
+                          const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+                          const Eigen::Vector<DataType,Eigen::Dynamic> &z,
+                          const Eigen::Vector<DataType,Eigen::Dynamic> &x0)
 {
 	// Ensure arguments are sound
 	if(H.rows() != H.cols())
@@ -586,6 +910,14 @@ QPSolver<DataType>::solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::D
 		                            "the inequality constraint matrix B had " + std::to_string(B.cols()) + " columns, and "
 		                            "the start point x0 had " + std::to_string(x0.size()) + " elements.");
 	}
+	else if(xMin.size() != x0.size() or xMax.size() != x0.size())
+	{
+		throw std::invalid_argument("[ERROR] [QP SOLVER] solve(): "
+		                            "Dimensions for the bounds do not match. "
+		                            "The lower bound had " + std::to_string(xMin.size()) + " elements, "
+		                            "the upper bound had " + std::to_string(xMax.size()) + " elements, and "
+		                            "the start point x0 had " + std::to_string(x0.size()) + " elements.");
+	}
 	else if(B.rows() != z.size())
 	{
 		throw std::invalid_argument("[ERROR] [QP SOLVER] solve(): "
@@ -594,80 +926,229 @@ QPSolver<DataType>::solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::D
 		                            "the inequality constraint vector z had " + std::to_string(z.size()) + " elements.");
 	}
 	
+	for(Eigen::Index j = 0; j < xMin.size(); j++)
+	{
+		if(xMin(j) >= xMax(j))
+		{
+			throw std::invalid_argument("[ERROR] [QP SOLVER] solve(): "
+			                            "The lower bound for element " + std::to_string(j) + " is not less than "
+			                            "the upper bound (" + std::to_string(xMin(j)) + " >= " + std::to_string(xMax(j)) + ").");
+		}
+	}
+	
+	interior_point(H, f, xMin, xMax, B, z, x0);
+	
+	this->lastSolution = this->workspace.x;                                                        // Save the value
+	
+	return this->lastSolution;
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Run the interior point algorithm on a problem in standard form           //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template <class DataType> inline
+void
+QPSolver<DataType>::interior_point(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &H,
+                                   const Eigen::Vector<DataType,Eigen::Dynamic> &f,
+                                   const Eigen::Vector<DataType,Eigen::Dynamic> &xMin,
+                                   const Eigen::Vector<DataType,Eigen::Dynamic> &xMax,
+                                   const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic> &B,
+                                   const Eigen::Vector<DataType,Eigen::Dynamic> &z,
+                                   const Eigen::Vector<DataType,Eigen::Dynamic> &x0)
+{
 	// h = 0.5*x'*H*x + x'*f - sum log(d_i),   d_i = z_i - b_i'*x
 	// g = H*x + f + sum (1/d_i)*b_i
 	// I = H + sum (1/d_i^2)*b_i*b_i'
+	//
+	// A bound is a constraint with b_i = +/- e_k, so it only adds to g(k) and I(k,k).
 	
 	// Variables used in this scope
 	DataType u = this->initialBarrierScalar;                                                       // As it says
 	unsigned int dim = x0.size();                                                                  // Dimensions of the decision varialbe
-	unsigned int numConstraints = z.size();                                                        // As it says
-	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> I(dim,dim);                              // Hessian matrix
-	Eigen::Vector<DataType,Eigen::Dynamic> g(dim);                                                 // Gradient vector
-	std::vector<DataType> d(numConstraints);                                                       // Distance to every constraint
-	std::vector<Eigen::Vector<DataType,Eigen::Dynamic>> b(numConstraints);                         // Row vectors of constraint matrix (transposed)
-	std::vector<Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic>> bbt(numConstraints);        // Outer product of row vectors
-	Eigen::Vector<DataType,Eigen::Dynamic> x(dim);                                                 // We want to solve for this
-	
-	// Do some pre-processing
-	bool initialConstraintViolated = false;
-	for(int j = 0; j < numConstraints; j++)
-	{
-		b[j]   = B.row(j).transpose();                                                            // Transpose the row vector
-		bbt[j] = b[j]*b[j].transpose();                                                           // Compute the outer product
-
-		d[j] = z(j) - b[j].dot(x0);                                                               // Distance to constraint
+	unsigned int numConstraints = z.size();                                                        // Number of general inequality constraints
+	
+	unsigned int numBounds = 0;                                                                    // Number of finite bounds
+	for(unsigned int k = 0; k < dim; k++)
+	{
+		if(std::isfinite(xMax(k))) numBounds++;
+		if(std::isfinite(xMin(k))) numBounds++;
+	}
+	
+	this->workspace.resize_interior_point(dim, numConstraints, numBounds);                         // Only if the dimensions changed
+	
+	Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &I = this->workspace.I;                  // Hessian matrix
+	Eigen::Vector<DataType,Eigen::Dynamic> &g  = this->workspace.g;                                // Gradient vector
+	Eigen::Vector<DataType,Eigen::Dynamic> &d  = this->workspace.d;                                // Distance to every general constraint
+	Eigen::Vector<DataType,Eigen::Dynamic> &x  = this->workspace.x;                                // We want to solve for this
+	Eigen::Vector<DataType,Eigen::Dynamic> &dx = this->workspace.dx;                               // Newton step
+	
+	// Lambda function for checking that a point is strictly inside all the constraints
+	auto is_interior = [&](const Eigen::Vector<DataType,Eigen::Dynamic> &point) -> bool
+	{
+		for(unsigned int k = 0; k < dim; k++)
+		{
+			if(point(k) <= xMin(k) or point(k) >= xMax(k)) return false;                          // Infinite bounds are never violated
+		}
+		
+		for(unsigned int j = 0; j < numConstraints; j++)
+		{
+			if(z(j) - B.row(j).dot(point) <= 0) return false;
+		}
 		
-		if(d[j] <= 0) initialConstraintViolated = true;                                           // Flag
+		return true;
+	};
+	
+	// Warm start only if the caller passed the last solution as the start point, so a point
+	// from some other problem is never used in place of x0, and only if it is strictly inside
+	// the new constraints
+	unsigned int numSolved = this->lastSolution.size();                                            // The last interior point ends with the last solution
+	this->warmStarted = false;
+	DataType minBarrierScalar = 0;                                                                 // Barrier is held here when warm starting
+	if(this->start == warm
+	and numSolved > 0
+	and numSolved <= dim
+	and this->lastInteriorPoint.size() == dim
+	and x0.tail(numSolved) == this->lastSolution
+	and is_interior(this->lastInteriorPoint))                                                      // Otherwise slack is gone, so start cold
+	{
+		this->warmStarted = true;
+		
+		x = this->lastInteriorPoint;
+		
+		// Resume from the last barrier, but hold it where a cold start would finish so the
+		// solution matches a cold start, and Newton's method converges on a fixed problem.
+		// The floor is clamped since it is tiny (~1e-58 by default) and underflows a float.
+		minBarrierScalar = std::max(this->initialBarrierScalar*std::pow(this->barrierReductionRate, DataType(this->maxSteps)),
+		                            std::numeric_limits<DataType>::min());
+		
+		u = (this->lastBarrierScalar > minBarrierScalar) ? this->lastBarrierScalar : minBarrierScalar;
 	}
 	
 	// Set the start point
-	if(initialConstraintViolated)
+	if(this->warmStarted) {}                                                                       // Already set
+	else if(not is_interior(x0))
 	{
-		Eigen::Vector<DataType,Eigen::Dynamic> dz
-		= 1e-03*Eigen::Vector<DataType,Eigen::Dynamic>::Ones(numConstraints);                     // Add a tiny offset so we're not exactly on the constraint      
+		// Move inside the bounds, a tiny offset from any that are violated
+		x = x0;
+		for(unsigned int k = 0; k < dim; k++)
+		{
+			DataType offset = min(1e-03, 0.5*(xMax(k) - xMin(k)));
+			
+			     if(x(k) <= xMin(k)) x(k) = xMin(k) + offset;
+			else if(x(k) >= xMax(k)) x(k) = xMax(k) - offset;
+		}
 		
-		     if(numConstraints > dim) x = (B.transpose()*B).ldlt().solve(B.transpose()*(z - dz)); // Underdetermined system
-		else if(numConstraints < dim) x =  B.transpose()*(B*B.transpose()).ldlt().solve(z - dz);  // Overdetermined system
-		else                          x =  B.partialPivLu().solve(z - dz);                        // Exact solution
+		if(not is_interior(x))
+		{
+			// Solve for a point just inside all the constraints, with the finite bounds
+			// written as rows of the constraint matrix
+			
+			Eigen::Matrix<DataType,Eigen::Dynamic,Eigen::Dynamic> &allB = this->workspace.allB;
+			Eigen::Vector<DataType,Eigen::Dynamic> &allZ = this->workspace.allZ;
+			
+			allB.setZero();
+			
+			unsigned int row = 0;
+			for(unsigned int k = 0; k < dim; k++)
+			{
+				if(std::isfinite(xMax(k))) { allB(row,k) =  1; allZ(row) =  xMax(k); row++; }
+				if(std::isfinite(xMin(k))) { allB(row,k) = -1; allZ(row) = -xMin(k); row++; }
+			}
+			
+			allB.bottomRows(numConstraints) = B;
+			allZ.tail(numConstraints)       = z;
+			
+			allZ.array() -= 1e-03;                                                                // Add a tiny offset so we're not exactly on the constraint
+			
+			unsigned int numRows = allZ.size();
+			
+			if(numRows >= dim)                                                                    // Overdetermined, or exact solution
+			{
+				I.noalias() = allB.transpose()*allB;                                              // I and g are reset in the loop below
+				g.noalias() = allB.transpose()*allZ;
+				this->workspace.decomposition.compute(I);
+				x = this->workspace.decomposition.solve(g);
+			}
+			else                                                                                  // Underdetermined system
+			{
+				this->workspace.allBBt.noalias() = allB*allB.transpose();
+				this->workspace.allDecomposition.compute(this->workspace.allBBt);
+				this->workspace.allLambda = this->workspace.allDecomposition.solve(allZ);
+				x.noalias() = allB.transpose()*this->workspace.allLambda;
+			}
+		}
 	}
 	else	x = x0;                                                                                   // Given start point
 	
 	// Run the interior point algorithm
-	for(int i = 0; i < this->maxSteps; i++)
+	for(unsigned int i = 0; i < this->maxSteps; i++)
 	{
 		this->numSteps = i+1;                                                                     // Increment the counter
 		
 		// (Re)set values for new loop
-		g = H*x + f;                                                                              // Gradient vector
+		g = f;
+		g.noalias() += H*x;                                                                       // Gradient vector
 		I = H;                                                                                    // Hessian matrix
 		
-		// Compute distance to every constraint
-		for(int j = 0; j < numConstraints; j++)
+		if(i == 0 and not is_interior(x))
+		{
+			throw std::runtime_error("[ERROR] [QP SOLVER] solve(): "
+			                         "Unable to find a solution that satisfies constraints.");
+		}
+		
+		// Add the barrier for each bound to the gradient and the diagonal of the Hessian
+		for(unsigned int k = 0; k < dim; k++)
 		{
-			d[j] = z(j) - b[j].dot(x);                                                           // Distance to constraint
+			if(std::isfinite(xMax(k)))
+			{
+				DataType dist = xMax(k) - x(k);                                                  // Distance to upper bound
+				
+				if(dist <= 0) dist = 1e-03;                                                      // Constraint violated; set a small, but non-zero distance
+				
+				g(k)   += u/dist;
+				I(k,k) += u/(dist*dist);
+			}
 			
-			if(i == 0 and d[j] <= 0)
+			if(std::isfinite(xMin(k)))
 			{
-				throw std::runtime_error("[ERROR] [QP SOLVER] solve(): "
-				                         "Unable to find a solution that satisfies constraints.");
+				DataType dist = x(k) - xMin(k);                                                  // Distance to lower bound
+				
+				if(dist <= 0) dist = 1e-03;
+				
+				g(k)   -= u/dist;
+				I(k,k) += u/(dist*dist);
 			}
+		}
+		
+		// Compute distance to every general constraint
+		for(unsigned int j = 0; j < numConstraints; j++)
+		{
+			d(j) = z(j) - B.row(j).dot(x);                                                       // Distance to constraint
 			
-			if(d[j] <= 0) d[j] = 1e-03;                                                          // Constraint violated; set a small, but non-zero distance
+			if(d(j) <= 0) d(j) = 1e-03;                                                          // Constraint violated; set a small, but non-zero distance
 		 
-			g += (u/d[j])*b[j];                                                                  // Add up gradient
-			I += (u/(d[j]*d[j]))*bbt[j];                                                         // Add up Hessian
+			g += (u/d(j))*B.row(j).transpose();                                                  // Add up gradient
+			
+			I.template selfadjointView<Eigen::Lower>().rankUpdate(B.row(j).transpose(), u/(d(j)*d(j))); // Add up Hessian
 		}
 
-		Eigen::Vector<DataType,Eigen::Dynamic> dx = I.ldlt().solve(-g);                           // Compute Newton step
+		this->workspace.decomposition.compute(I);                                                 // Only reads the lower triangle
+		dx = -g;
+		this->workspace.decomposition.solveInPlace(dx);                                           // Compute Newton step
 		
 		// Compute scalar for step size so that constraint is not violated on next step
 		DataType alpha = 1.0;
-		for(int j = 0; j < numConstraints; j++)
+		for(unsigned int k = 0; k < dim; k++)
 		{
-			DataType dotProd = b[j].dot(dx);                                                     // Makes calcs a little easier
+			if(x(k) + dx(k) >= xMax(k)) alpha = min(alpha, 0.9*(xMax(k) - x(k))/dx(k));         // Shrink scalar if upper bound violated
+			if(x(k) + dx(k) <= xMin(k)) alpha = min(alpha, 0.9*(xMin(k) - x(k))/dx(k));         // Shrink scalar if lower bound violated
+		}
+		
+		for(unsigned int j = 0; j < numConstraints; j++)
+		{
+			DataType dotProd = B.row(j).dot(dx);                                                 // Makes calcs a little easier
 			
-			if(d[j] - dotProd <= 0) alpha = min(alpha,0.9*d[j]/dotProd);                         // Shrink scalar if constraint violated
+			if(d(j) - dotProd <= 0) alpha = min(alpha,0.9*d(j)/dotProd);                         // Shrink scalar if constraint violated
 		}
 		
 		dx *= alpha;                                                                              // Scale the step
@@ -679,11 +1160,12 @@ QPSolver<DataType>::solve(const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::D
 		// Increment values for next loop
 		x += dx;                                                                                  // Increment state
 		u *= this->barrierReductionRate;                                                          // Reduce barrier
+		
+		if(u < minBarrierScalar) u = minBarrierScalar;                                            // Only when warm starting
 	}
 	
-	this->lastSolution = x;                                                                        // Save the value
-	
-	return x;
+	this->lastInteriorPoint = x;                                                                   // For warm starting the next call
+	this->lastBarrierScalar = u;
 }
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -795,4 +1277,26 @@ void QPSolver<DataType>::use_primal()
 	std::cout << "[INFO] [QP SOLVER] Using the primal method to solve.\n";
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Start the interior point algorithm from the previous solution                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+void QPSolver<DataType>::use_warm_start()
+{
+	this->start = warm;
+	
+	std::cout << "[INFO] [QP SOLVER] Warm starting from the last solution.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Start the interior point algorithm from the given start point                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+void QPSolver<DataType>::use_cold_start()
+{
+	this->start = cold;
+	
+	std::cout << "[INFO] [QP SOLVER] Starting from the given start point.\n";
+}
+
 #endif
@@ -0,0 +1,86 @@
+/**
+ * @file   SpatialAlgebra.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Inline functions for 6D spatial vector arithmetic.
+ *
+ * Spatial quantities are expressed in the global (base) frame and referenced to its origin.
+ * Motion vectors are ordered [linear ; angular], and force vectors are ordered [force ; moment],
+ * consistent with the twist and Jacobian conventions used elsewhere in the library.
+ *
+ * @see Featherstone, R. (2008) "Rigid Body Dynamics Algorithms", Springer.
+ */
+
+#ifndef SPATIALALGEBRA_H_
+#define SPATIALALGEBRA_H_
+
+#include <Eigen/Core>
+
+namespace RobotLibrary {
+
+/**
+ * Cross product of two spatial motion vectors, i.e. the derivative of m moving with velocity v.
+ * @param v A spatial velocity [linear ; angular].
+ * @param m A spatial motion vector [linear ; angular].
+ * @return The 6D motion vector v x m.
+ */
+inline
+Eigen::Vector<double,6>
+cross_motion(const Eigen::Vector<double,6> &v,
+             const Eigen::Vector<double,6> &m)
+{
+     Eigen::Vector<double,6> result;
+     result.head(3) = v.tail<3>().cross(m.head<3>()) + v.head<3>().cross(m.tail<3>());
+     result.tail(3) = v.tail<3>().cross(m.tail<3>());
+     return result;
+}
+
+/**
+ * Cross product of a spatial motion vector with a spatial force vector.
+ * @param v A spatial velocity [linear ; angular].
+ * @param f A spatial force [force ; moment].
+ * @return The 6D force vector v x* f.
+ */
+inline
+Eigen::Vector<double,6>
+cross_force(const Eigen::Vector<double,6> &v,
+            const Eigen::Vector<double,6> &f)
+{
+     Eigen::Vector<double,6> result;
+     result.head(3) = v.tail<3>().cross(f.head<3>());
+     result.tail(3) = v.tail<3>().cross(f.tail<3>()) + v.head<3>().cross(f.head<3>());
+     return result;
+}
+
+/**
+ * Form the 6x6 spatial inertia of a rigid body about the origin of the global frame.
+ * @param mass The mass of the body (kg).
+ * @param inertia The moment of inertia about the center of mass, in the global frame (kg*m^2).
+ * @param centerOfMass The location of the center of mass in the global frame (m).
+ * @return A symmetric 6x6 matrix mapping spatial velocity to spatial momentum.
+ */
+inline
+Eigen::Matrix<double,6,6>
+spatial_inertia(const double          &mass,
+                const Eigen::Matrix3d &inertia,
+                const Eigen::Vector3d &centerOfMass)
+{
+     Eigen::Matrix3d C;
+     C <<               0 , -centerOfMass(2),  centerOfMass(1),
+          centerOfMass(2),                0 , -centerOfMass(0),
+         -centerOfMass(1),  centerOfMass(0),                0 ;                                     // Skew-symmetric matrix of the center of mass
+
+     // I = [  m*I   -m*C      ]
+     //     [  m*C   Ic - m*C*C ]
+
+     Eigen::Matrix<double,6,6> I;
+     I.block<3,3>(0,0) = mass*Eigen::Matrix3d::Identity();
+     I.block<3,3>(0,3) = -mass*C;
+     I.block<3,3>(3,0) =  mass*C;
+     I.block<3,3>(3,3) = inertia - mass*C*C;
+     return I;
+}
+
+}
+
+#endif
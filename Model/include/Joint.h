@@ -93,7 +93,7 @@ class Joint
            * @param position The joint position (radians or metres)
            * @return The local pose origin.
            */
-          Pose position_offset(const double &position);
+          Pose position_offset(const double &position) const;
           
           /**
            * @return Returns the pose of this joint relative to the parent link in a kinematic chain.
@@ -1,271 +1,1302 @@
-/**
- * @file   KinematicTree.h
- * @author Jon Woolfrey
- * @date   September 2023
- * @brief  A class representing multiple rigid bodies connected in series by actuated joints.
- */
- 
-#ifndef KINEMATICTREE_H_
-#define KINEMATICTREE_H_
-
-#include "Joint.h"                                                                                  // Custom class for describing a moveable connection between links
-#include "Link.h"                                                                                   // Custom class combining a rigid body and joint
-#include "SkewSymmetric.h"                                                                          // Custom class
-
-#include <fstream>                                                                                  // For loading files
-#include <map>                                                                                      // map
-#include <tinyxml2.h>                                                                               // For parsing urdf files
-
-namespace RobotLibrary {
-
-/**
- * A structure containing necessary information for defining a reference frame on a kinematic tree.
- */
-struct ReferenceFrame
-{
-     Link *link = nullptr;                                                                          ///< The link it is attached to
-     Pose relativePose;                                                                             ///< Pose with respect to local link frame
-};
-
-/**
- * A class that defines the kinematics and dynamics of branching, serial link structures.
- */
-class KinematicTree
-{
-     public:
-          /**
-           * Constructor for a kinematic tree.
-           * @param pathToURDF The location of a URDF file that specifies are robot structure.
-           */
-          KinematicTree(const std::string &pathToURDF);                                             // Constructor from URDF
-          
-          /**
-           * Updates the forward kinematics and inverse dynamics. Used for fixed base structures.
-           * @param jointPosition A vector of the joint positions.
-           * @param jointVelocity A vector of the joint velocities.
-           * @return Returns false if there is a problem.
-           */
-          bool
-          update_state(const Eigen::VectorXd &jointPosition,
-                       const Eigen::VectorXd &jointVelocity)
-          {
-               return update_state(jointPosition, jointVelocity, this->base.pose(), Eigen::Vector<double,6>::Zero());
-          }
-          
-          /**
-           * Updates the forward kinematics and inverse dynamics. Used for floating base structures.
-           * @param jointPosition A vector of all the joint positions.
-           * @param jointVelocity A vector of all the joint velocities.
-           * @param basePose The transform of the base relative to some global reference frame.
-           * @param baseTwist The velocity of the base relative to some global reference frame.
-           */
-          bool
-          update_state(const Eigen::VectorXd         &jointPosition,
-                       const Eigen::VectorXd         &jointVelocity,
-                       const Pose                    &basePose,
-                       const Eigen::Vector<double,6> &baseTwist);
-
-          /**
-           * Query how many controllable joints there are in this model.
-           * @return Returns what you asked for.
-           */
-          unsigned int
-          number_of_joints() const { return this->_numberOfJoints; }
-          
-          /**
-           * Get the coupled inertia matrix between the actuated joints and the base.
-           * @return An nx6 Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, Eigen::Dynamic, 6>
-          joint_base_inertia_matrix() const { return this->_jointBaseInertiaMatrix; }
-          
-          /**
-           * Get the coupled inertia matrix between the base and actuated joints.
-           * @return A 6xn Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, 6, Eigen::Dynamic>
-          base_joint_inertia_matrix() const { return this->_jointBaseInertiaMatrix.transpose(); }
-          
-          /**
-           * Get the Coriolis matrix pertaining to coupled inertia between the actuated joints and base.
-           * @return An nx6 Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, Eigen::Dynamic, 6>
-          joint_base_coriolis_matrix() const { return this->_jointBaseCoriolisMatrix; }
-          
-          /**
-           * Get the Coriolis matrix pertaining to coupled inertia between the base and actuated joints.
-           * @return A 6xn Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, 6, Eigen::Dynamic>
-          base_joint_coriolis_matrix() const { return -this->_jointBaseCoriolisMatrix.transpose(); }
-          
-          /**
-           * Get the inertia matrix in the joint space of the model / robot.
-           * @return Returns an nxn Eigen::Matrix object.
-           */            
-          Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>
-          joint_inertia_matrix() const { return this->_jointInertiaMatrix; }
-          
-          /**
-           * Get the matrix pertaining to centripetal and Coriolis torques in the joints of the model.
-           * @return Returns an nxn Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>
-          joint_coriolis_matrix() const { return this->_jointCoriolisMatrix; } 
-
-          /**
-           * Get the matrix that maps joint motion to Cartesian motion of the specified frame.
-           * @return Returns a 6xn Eigen::Matrix object.
-           */
-          Eigen::Matrix<double, 6, Eigen::Dynamic>
-          jacobian(const std::string &frameName); 
-
-          /**
-           * Compute the time derivative for a given Jacobian matrix.
-           * @param J The Jacobian for which to take the time derivative.
-           * @return A 6xn matrix for the time derivative.
-           */
-          Eigen::Matrix<double, 6, Eigen::Dynamic>
-          time_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix);
-          
-          /**
-           * Compute the partial derivative for a Jacobian with respect to a given joint.
-           * @param J The Jacobian with which to take the derivative
-           * @param jointNumber The joint (link) number for which to take the derivative.
-           * @return A 6xn matrix for the partial derivative of the Jacobian.
-           */
-          Eigen::Matrix<double, 6, Eigen::Dynamic>
-          partial_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix,
-                             const unsigned int &jointNumber);
-
-          /**
-           * Get the pose of a specified reference frame on the kinematic tree.
-           * @return Returns a RobotLibrary::Pose object.
-           */
-          Pose
-          frame_pose(const std::string &frameName);
-          
-          /**
-           * Get the joint torques from viscous friction.
-           * @return An nx1 Eigen::Vector object
-           */
-          Eigen::Vector<double,Eigen::Dynamic>
-          joint_damping_vector() const { return this->_jointDampingVector; }
-               
-          /**
-           * Get the joint torques needed to oppose gravitational acceleration.
-           * @return Returns an nx1 Eigen::Vector object.
-           */   
-          Eigen::VectorXd
-          joint_gravity_vector() const { return this->_jointGravityVector; }
-          
-          /** 
-           * Get the current joint velocities of all the joints in the model.
-           * @return Returns an nx1 Eigen::Vector object.
-           */
-          Eigen::VectorXd
-          joint_velocities() const { return this->_jointVelocity; }
-          
-          /**
-           * Get the name of this model.
-           * @return Returns a std::string object.
-           */
-          std::string
-          name() const { return this->_name; }
-          
-          /**
-           * Returns a pointer to a reference frame on this model.
-           * @param name In the URDF, the name of the parent link attached to a fixed joint
-           * @return A ReferenceFrame data structure.
-           */
-          ReferenceFrame*
-          find_frame(const std::string &frameName);
-          
-          /**
-           * Compute a matrix that relates joint motion to Cartesian motion for a frame on the robot.
-           * @param frame A pointer to the reference frame on the model.
-           * @return A 6xn Eigen::Matrix object.
-           */
-          Eigen::Matrix<double,6,Eigen::Dynamic>
-          jacobian(ReferenceFrame *frame);
-          
-          /**
-           * Get the joint position vector in the underlying model.
-           * @return An nx1 Eigen::Vector object of all the joint positions.
-           */
-          Eigen::Vector<double,Eigen::Dynamic>
-          joint_positions() const { return this->_jointPosition; }
-          
-          /**
-           * Return a pointer to a link on the structure.
-           * @param The number of the link in the model.
-           * @return A RobotLibrary::Link object
-           */
-          Link*
-          link(const unsigned int &linkNumber);
-          
-          /**
-           * @param number The number for the joint in the model.
-           * @return A pointer to a RobotLibrary::Joint object
-           */
-          Joint
-          joint(const unsigned int &jointNumber) { return link(jointNumber)->joint(); }
-
-          RigidBody base;                                                                           ///< Specifies the dynamics for the base.
-          
-     private:
-          
-          Eigen::Matrix<double,Eigen::Dynamic,6> _jointBaseCoriolisMatrix;                          ///< Inertial coupling between base and links
-          
-          Eigen::Matrix<double,Eigen::Dynamic,6> _jointBaseInertiaMatrix;                           ///< Inertial coupling between base and links
-          
-          Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic> _jointCoriolisMatrix;                 ///< As it says on the label.
-          
-          Eigen::Vector<double,Eigen::Dynamic> _jointDampingVector;                                 ///< From viscous friction in the joints
-          
-          Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic> _jointInertiaMatrix;                  ///< As it says on the label.
-
-          Eigen::Vector3d _gravityVector = {0,0,-9.81};                                             ///< 3x1 vector for the gravitational acceleration.
-               
-          Eigen::Vector<double,Eigen::Dynamic> _jointPosition;                                      ///< A vector of all the joint positions.
-
-          Eigen::Vector<double,Eigen::Dynamic> _jointVelocity;                                      ///< A vector of all the joint velocities.
-
-          Eigen::Vector<double,Eigen::Dynamic> _jointGravityVector;                                 ///< A vector of all the gravitational joint torques.
-           
-          std::map<std::string, ReferenceFrame> _frameList;                                         ///< A dictionary of reference frames on the kinematic tree.
-          
-          std::vector<Link> _fullLinkList;                                                          ///< An array of all the links in the model, including fixed joints.
-          
-          std::vector<Link*> _link;                                                                 ///< An array of all the actuated links.
-          
-          std::vector<Link*> _baseLinks;                                                            ///< Array of links attached directly to the base.
-          
-          std::string _name;                                                                        ///< A unique name for this model.
-          
-          unsigned int _numberOfJoints;                                                             ///< The number of actuated joint in the kinematic tree.
-                  
-          /**
-           * Computes the Jacobian to a given point on a given link.
-           * @param link A pointer to the link for the Jacobian
-           * @param point A point relative to the link with which to compute the Jacobian
-           * @param numberOfColumns Number of columns for the Jacobian (can be used to speed up calcs)
-           * @return A 6xn Jacobian matrix.
-           */
-          Eigen::Matrix<double,6,Eigen::Dynamic>
-          jacobian(Link *link,
-                   const Eigen::Vector3d &point,
-                   const unsigned int &numberOfColumns);
-
-          /**
-           * Converts a char array to a 3x1 vector. Used in the constructor.
-           * @param character A char array
-           * @return Returns a 3x1 Eigen vector object.
-           */
-          Eigen::Vector3d char_to_vector(const char* character);                      
-};                                                                                                  // Semicolon needed after class declarations
-
-}
-
-#endif
+/**
+ * @file   KinematicTree.h
+ * @author Jon Woolfrey
+ * @date   September 2023
+ * @brief  A class representing multiple rigid bodies connected in series by actuated joints.
+ */
+ 
+#ifndef KINEMATICTREE_H_
+#define KINEMATICTREE_H_
+
+#include "Joint.h"                                                                                  // Custom class for describing a moveable connection between links
+#include "Link.h"                                                                                   // Custom class combining a rigid body and joint
+#include "SkewSymmetric.h"                                                                          // Custom class
+#include "SpatialAlgebra.h"                                                                         // 6D cross products and spatial inertia
+#include "WorkerPool.h"                                                                             // Persistent threads for parallel evaluation
+
+#include <exception>                                                                                // std::exception_ptr
+#include <fstream>                                                                                  // For loading files
+#include <functional>                                                                               // std::function
+#include <map>                                                                                      // map
+#include <memory>                                                                                   // std::shared_ptr
+#include <thread>                                                                                   // std::thread
+#include <tinyxml2.h>                                                                               // For parsing urdf files
+
+#ifndef ROBOT_LIBRARY_MAX_JOINTS
+     #define ROBOT_LIBRARY_MAX_JOINTS Eigen::Dynamic                                                // No limit, so joint-space matrices are allocated on the heap
+#endif
+
+namespace RobotLibrary {
+
+/**
+ * The largest number of joints a model may have. When this is set at compile time, e.g. with
+ * -DROBOT_LIBRARY_MAX_JOINTS=7, joint-space vectors and matrices are stored inside their objects
+ * rather than on the heap, but are still sized to the actual number of joints at run time.
+ */
+constexpr int MaxJoints = ROBOT_LIBRARY_MAX_JOINTS;
+
+using JointVector     = Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MaxJoints, 1>;         ///< nx1 vector of joint values
+using JointMatrix     = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxJoints, MaxJoints>; ///< nxn joint-space matrix
+using JointBaseMatrix = Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::ColMajor, MaxJoints, 6>;         ///< nx6 coupling between joints and base
+using JacobianMatrix  = Eigen::Matrix<double, 6, Eigen::Dynamic, Eigen::ColMajor, 6, MaxJoints>;         ///< 6xn Jacobian
+
+/**
+ * A structure containing necessary information for defining a reference frame on a kinematic tree.
+ */
+struct ReferenceFrame
+{
+     Link *link = nullptr;                                                                          ///< The link it is attached to
+     Pose relativePose;                                                                             ///< Pose with respect to local link frame
+     std::vector<unsigned int> supportingJoints;                                                    ///< Numbers of the joints that move this frame, ordered from the base.
+};
+
+/**
+ * The number of a reference frame on a kinematic tree, from KinematicTree::frame_id().
+ * It is a distinct type so that it can't be mistaken for a joint number or a null pointer.
+ */
+struct FrameID
+{
+     unsigned int number;                                                                           ///< Position of the frame in the model's list
+};
+
+/**
+ * Memory reserved for intermediate results of the kinematics and dynamics algorithms.
+ * It is sized once when the model is constructed so that updating the state does not allocate.
+ * Arrays of link quantities are in topological order, i.e. every parent precedes its children.
+ */
+struct KinematicTreeWorkspace
+{
+     std::vector<Pose> pose;                                                                        ///< Pose of each link
+     
+     std::vector<Eigen::Vector<double,6>> motionSubspace;                                           ///< Spatial axis of each joint
+     
+     std::vector<Eigen::Vector<double,6>> velocity;                                                 ///< Spatial velocity of each link
+     
+     std::vector<Eigen::Vector<double,6>> acceleration;                                             ///< Spatial acceleration of each link
+     
+     std::vector<Eigen::Vector<double,6>> force;                                                    ///< Spatial force on each link or subtree
+     
+     std::vector<Eigen::Vector<double,6>> bias;                                                     ///< Velocity-product acceleration of each joint
+     
+     std::vector<Eigen::Vector<double,6>> inertiaAxis;                                              ///< Articulated inertia times joint axis
+     
+     std::vector<Eigen::Vector<double,6>> velocityDerivative;                                       ///< Partial derivative of each link velocity
+     
+     std::vector<Eigen::Vector<double,6>> accelerationDerivative;                                   ///< Partial derivative of each link acceleration
+     
+     std::vector<Eigen::Vector<double,6>> forceDerivative;                                          ///< Partial derivative of the force on each subtree
+     
+     std::vector<Eigen::Matrix<double,6,6>> inertia;                                                ///< Spatial inertia of each link or subtree
+     
+     JointVector axisInertia;                                                                       ///< Inertia about each joint axis
+     
+     JointVector axisTorque;                                                                        ///< Torque available to accelerate each joint
+     
+     JacobianMatrix jacobian;                                                                       ///< Jacobian to a point on a link
+     
+     JacobianMatrix jacobianDerivative;                                                             ///< Time derivative of the Jacobian
+     
+     Eigen::Matrix<double,3,Eigen::Dynamic,Eigen::ColMajor,3,MaxJoints> product;                     ///< Intermediate matrix product
+     
+     /**
+      * Allocate memory for a given number of joints.
+      * @param numberOfJoints The number of actuated joints in the model.
+      */
+     void
+     resize(const unsigned int &numberOfJoints)
+     {
+          pose.resize(numberOfJoints);
+          motionSubspace.resize(numberOfJoints);
+          velocity.resize(numberOfJoints);
+          acceleration.resize(numberOfJoints);
+          force.resize(numberOfJoints);
+          bias.resize(numberOfJoints);
+          inertiaAxis.resize(numberOfJoints);
+          velocityDerivative.resize(numberOfJoints);
+          accelerationDerivative.resize(numberOfJoints);
+          forceDerivative.resize(numberOfJoints);
+          inertia.resize(numberOfJoints);
+          axisInertia.resize(numberOfJoints);
+          axisTorque.resize(numberOfJoints);
+          jacobian.resize(6,numberOfJoints);
+          jacobianDerivative.resize(6,numberOfJoints);
+          product.resize(3,numberOfJoints);
+     }
+};
+
+/**
+ * The state of a kinematic tree for one thread. The model itself is not changed by the functions
+ * that take this as an argument, so a single model can be shared by many threads (e.g. as a
+ * std::shared_ptr<const KinematicTree>), each with its own data, without locks or copies of the model.
+ * Create it with KinematicTree::make_data() so the memory is the right size.
+ */
+struct KinematicTreeData
+{
+     JointVector jointPosition;                                                                     ///< Joint positions from the last update
+     
+     JointVector jointVelocity;                                                                     ///< Joint velocities from the last update
+     
+     Pose basePose;                                                                                 ///< Pose of the base from the last update
+     
+     Eigen::Vector<double,6> baseTwist = Eigen::Vector<double,6>::Zero();                           ///< Velocity of the base from the last update
+     
+     Eigen::Vector<double,6> baseAcceleration = Eigen::Vector<double,6>::Zero();                    ///< Linear and angular acceleration of the base, for inverse_dynamics()
+     
+     Eigen::Vector3d gravity = {0,0,-9.81};                                                         ///< Gravitational acceleration in the base frame, copied from the model by make_data()
+     
+     JointMatrix jointInertiaMatrix;                                                                ///< Result of the last call to joint_inertia_matrix()
+     
+     KinematicTreeWorkspace workspace;                                                              ///< Link states, and memory for the dynamics
+     
+     /**
+      * Allocate memory for a given number of joints.
+      * @param numberOfJoints The number of actuated joints in the model.
+      */
+     void
+     resize(const unsigned int &numberOfJoints)
+     {
+          jointPosition.setZero(numberOfJoints);
+          jointVelocity.setZero(numberOfJoints);
+          jointInertiaMatrix.setZero(numberOfJoints,numberOfJoints);
+          workspace.resize(numberOfJoints);
+     }
+};
+
+/**
+ * A class that defines the kinematics and dynamics of branching, serial link structures.
+ */
+class KinematicTree
+{
+     public:
+          /**
+           * Constructor for a kinematic tree.
+           * @param pathToURDF The location of a URDF file that specifies are robot structure.
+           */
+          KinematicTree(const std::string &pathToURDF);                                             // Constructor from URDF
+          
+          KinematicTree(const KinematicTree&) = delete;                                             // Links and frames point in to the model's own lists
+          
+          KinematicTree& operator=(const KinematicTree&) = delete;
+          
+          KinematicTree(KinematicTree&&) = delete;                                                  // Share a model with std::shared_ptr instead
+          
+          KinematicTree& operator=(KinematicTree&&) = delete;
+          
+          /**
+           * Updates the forward kinematics and inverse dynamics. Used for fixed base structures.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @return Returns false if there is a problem.
+           */
+          bool
+          update_state(const Eigen::VectorXd &jointPosition,
+                       const Eigen::VectorXd &jointVelocity)
+          {
+               return update_state(jointPosition, jointVelocity, this->base.pose(), Eigen::Vector<double,6>::Zero());
+          }
+          
+          /**
+           * Updates the forward kinematics and inverse dynamics. Used for floating base structures.
+           * @param jointPosition A vector of all the joint positions.
+           * @param jointVelocity A vector of all the joint velocities.
+           * @param basePose The transform of the base relative to some global reference frame.
+           * @param baseTwist The velocity of the base relative to some global reference frame.
+           */
+          bool
+          update_state(const Eigen::VectorXd         &jointPosition,
+                       const Eigen::VectorXd         &jointVelocity,
+                       const Pose                    &basePose,
+                       const Eigen::Vector<double,6> &baseTwist);
+          
+          /**
+           * Create memory for the state of this model, to be used by one thread.
+           * @return A data structure sized for this model, with the base at its current pose.
+           */
+          KinematicTreeData
+          make_data() const;
+          
+          /**
+           * Updates the forward kinematics for one thread, without altering the model. Used for fixed base structures.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param data The state for this thread, created by make_data().
+           */
+          void
+          update_state(const Eigen::VectorXd &jointPosition,
+                       const Eigen::VectorXd &jointVelocity,
+                       KinematicTreeData     &data) const
+          {
+               update_state(jointPosition, jointVelocity, data.basePose, data.baseTwist, data);
+          }
+          
+          /**
+           * Updates the forward kinematics for one thread, without altering the model. Used for floating base structures.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param basePose The transform of the base relative to some global reference frame.
+           * @param baseTwist The velocity of the base relative to some global reference frame.
+           * @param data The state for this thread, created by make_data().
+           */
+          void
+          update_state(const Eigen::VectorXd         &jointPosition,
+                       const Eigen::VectorXd         &jointVelocity,
+                       const Pose                    &basePose,
+                       const Eigen::Vector<double,6> &baseTwist,
+                       KinematicTreeData             &data) const;
+          
+          /**
+           * Get the pose of a reference frame from the state of one thread.
+           * @param frame A pointer to the reference frame on the model.
+           * @param data The state from the last call to update_state() with this data.
+           * @return The pose of the frame relative to the global frame.
+           */
+          Pose
+          frame_pose(const ReferenceFrame *frame, const KinematicTreeData &data) const;
+          
+          /**
+           * Compute the Jacobian for a frame on the robot from the state of one thread.
+           * @param frame A pointer to the reference frame on the model.
+           * @param data The state from the last call to update_state() with this data.
+           * @return A 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double,6,Eigen::Dynamic>
+          jacobian(const ReferenceFrame *frame, const KinematicTreeData &data) const;
+          
+          /**
+           * Compute the joint inertia matrix from the state of one thread.
+           * @param data The state from the last call to update_state() with this data.
+           * @return A reference to the nxn matrix stored in the data.
+           */
+          const JointMatrix&
+          joint_inertia_matrix(KinematicTreeData &data) const;
+          
+          /**
+           * Compute the joint torques required to achieve a given joint acceleration from the state of one thread.
+           * The base acceleration and gravity are taken from the data, not the model.
+           * @param jointAcceleration A vector of the joint accelerations.
+           * @param data The state from the last call to update_state() with this data.
+           * @return An nx1 vector of joint torques tau = M*qddot + (C + D)*qdot + g.
+           */
+          Eigen::VectorXd
+          inverse_dynamics(const Eigen::VectorXd &jointAcceleration, KinematicTreeData &data) const;
+
+          /**
+           * Compute the joint torques required to achieve a given joint acceleration.
+           * This uses the recursive Newton-Euler algorithm, which is O(n) in the number of joints,
+           * and does not alter the state of the model. The base is assumed to move with its current
+           * pose and twist, and zero acceleration.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param jointAcceleration A vector of the joint accelerations.
+           * @return An nx1 vector of joint torques tau = M*qddot + (C + D)*qdot + g.
+           */
+          Eigen::VectorXd
+          inverse_dynamics(const Eigen::VectorXd &jointPosition,
+                           const Eigen::VectorXd &jointVelocity,
+                           const Eigen::VectorXd &jointAcceleration);
+                           
+          /**
+           * Compute the joint accelerations that result from applying given joint torques.
+           * This uses the Articulated Body Algorithm, which is O(n) in the number of joints,
+           * and does not alter the state of the model. The base is assumed to move with its current
+           * pose and twist, and zero acceleration.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param jointTorque A vector of the torques applied at the joints.
+           * @return An nx1 vector of joint accelerations qddot = M^-1*(tau - (C + D)*qdot - g).
+           */
+          Eigen::VectorXd
+          forward_dynamics(const Eigen::VectorXd &jointPosition,
+                           const Eigen::VectorXd &jointVelocity,
+                           const Eigen::VectorXd &jointTorque);
+          
+          /**
+           * Compute the partial derivatives of the inverse dynamics with respect to the joint state.
+           * These are found analytically by differentiating the recursive Newton-Euler algorithm,
+           * in O(n^2) time, and do not alter the state of the model.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param jointAcceleration A vector of the joint accelerations.
+           * @param torqueByPosition An nxn matrix in which to store d(tau)/dq.
+           * @param torqueByVelocity An nxn matrix in which to store d(tau)/d(qdot), including joint friction.
+           */
+          void
+          inverse_dynamics_derivatives(const Eigen::VectorXd &jointPosition,
+                                       const Eigen::VectorXd &jointVelocity,
+                                       const Eigen::VectorXd &jointAcceleration,
+                                       Eigen::MatrixXd &torqueByPosition,
+                                       Eigen::MatrixXd &torqueByVelocity);
+          
+          /**
+           * Compute the partial derivatives of the forward dynamics with respect to the joint state and torques.
+           * Since M*qddot = tau - h(q,qdot), these are -M^-1*d(tau)/dq, -M^-1*d(tau)/d(qdot), and M^-1,
+           * evaluated at the joint accelerations given by the Articulated Body Algorithm.
+           * This does not alter the state of the model.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param jointTorque A vector of the torques applied at the joints.
+           * @param accelerationByPosition An nxn matrix in which to store d(qddot)/dq.
+           * @param accelerationByVelocity An nxn matrix in which to store d(qddot)/d(qdot).
+           * @param accelerationByTorque An nxn matrix in which to store d(qddot)/d(tau), i.e. the inverse of the inertia matrix.
+           */
+          void
+          forward_dynamics_derivatives(const Eigen::VectorXd &jointPosition,
+                                       const Eigen::VectorXd &jointVelocity,
+                                       const Eigen::VectorXd &jointTorque,
+                                       Eigen::MatrixXd &accelerationByPosition,
+                                       Eigen::MatrixXd &accelerationByVelocity,
+                                       Eigen::MatrixXd &accelerationByTorque);
+          
+          /**
+           * Compute the joint torques needed to hold the robot still against gravity at a given configuration.
+           * This is a single O(n) pass over the tree, so it can be called at a high rate without update_state().
+           * It uses its own memory and does not write to the model.
+           * @param jointPosition A vector of the joint positions.
+           * @return An nx1 vector of joint torques g(q) for the gravity vector of this model.
+           */
+          Eigen::VectorXd
+          gravity_torques(const Eigen::VectorXd &jointPosition) const
+          {
+               return gravity_torques(jointPosition, this->_gravityVector);
+          }
+          
+          /**
+           * Compute the joint torques needed to hold the robot still against gravity at a given configuration.
+           * This is a single O(n) pass over the tree. It uses its own memory and does not write to the model.
+           * @param jointPosition A vector of the joint positions.
+           * @param gravity The 3x1 gravitational acceleration in the base frame (m/s^2), e.g. for a tilted robot.
+           * @return An nx1 vector of joint torques g(q).
+           */
+          Eigen::VectorXd
+          gravity_torques(const Eigen::VectorXd &jointPosition,
+                          const Eigen::Vector3d &gravity) const;
+          
+          /**
+           * Compute the joint torques needed to hold the robot still against gravity, using the memory,
+           * base pose and gravity of one thread. Use this when another thread calls update_state() on the model.
+           * @param jointPosition A vector of the joint positions.
+           * @param data The state of one thread, created with make_data(). Its link poses are overwritten.
+           * @return An nx1 vector of joint torques g(q) for the gravity vector in the data.
+           */
+          Eigen::VectorXd
+          gravity_torques(const Eigen::VectorXd &jointPosition,
+                          KinematicTreeData     &data) const;
+          
+          /**
+           * Compute the position and orientation of every link for many joint configurations, in parallel.
+           * Velocities and inertias are skipped, and several configurations are evaluated at once in
+           * SIMD registers, so this is suited to collision checking in sampling-based planners.
+           * This does not alter the state of the model. The base is assumed to be at its current pose.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @param linkPositions A (3*n)xm matrix in which to store the position of link i in rows 3*i to 3*i+2.
+           * @param linkRotations A (9*n)xm matrix in which to store the rotation matrix of link i, column by column, in rows 9*i to 9*i+8.
+           */
+          void
+          batch_forward_kinematics(const Eigen::MatrixXd &jointPositions,
+                                   Eigen::MatrixXd &linkPositions,
+                                   Eigen::MatrixXd &linkRotations) const;
+          
+          /**
+           * Compute the pose of a frame for many joint configurations, in parallel.
+           * This does not alter the state of the model. The base is assumed to be at its current pose.
+           * @param frame A pointer to the reference frame on the model.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @return An array of m poses.
+           */
+          std::vector<Pose>
+          batch_frame_pose(ReferenceFrame *frame,
+                           const Eigen::MatrixXd &jointPositions) const;
+          
+          /**
+           * Compute the Jacobian of a frame for many joint configurations, in parallel.
+           * This does not alter the state of the model. The base is assumed to be at its current pose.
+           * @param frame A pointer to the reference frame on the model.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @return A (6*m)xn matrix where rows 6*i to 6*i+5 are the Jacobian for column i.
+           */
+          Eigen::MatrixXd
+          batch_jacobian(ReferenceFrame *frame,
+                         const Eigen::MatrixXd &jointPositions) const;
+          
+          /**
+           * Compute the joint inertia matrix for many joint configurations, in parallel.
+           * This does not alter the state of the model.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @return An (n*m)xn matrix where rows n*i to n*i+n-1 are the inertia matrix for column i.
+           */
+          Eigen::MatrixXd
+          batch_joint_inertia_matrix(const Eigen::MatrixXd &jointPositions) const;
+          
+          /**
+           * Compute the joint torques for many joint states, in parallel, using the recursive Newton-Euler algorithm.
+           * This does not alter the state of the model. The base is assumed to move with its current
+           * pose and twist, and zero acceleration.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @param jointVelocities An nxm matrix of the corresponding joint velocities.
+           * @param jointAccelerations An nxm matrix of the corresponding joint accelerations.
+           * @return An nxm matrix where each column is the joint torque vector.
+           */
+          Eigen::MatrixXd
+          batch_inverse_dynamics(const Eigen::MatrixXd &jointPositions,
+                                 const Eigen::MatrixXd &jointVelocities,
+                                 const Eigen::MatrixXd &jointAccelerations) const;
+          
+          /**
+           * Set the number of threads used by the batch functions, and by update_state() in parallel mode.
+           * The default is the number of concurrent threads supported by the hardware.
+           * The threads are created here and reused on every call, so this should not be called in a control loop.
+           * @param numberOfThreads Must be greater than zero.
+           * @return Returns false if there was a problem.
+           */
+          bool
+          set_number_of_threads(const unsigned int &numberOfThreads);
+          
+          /**
+           * Query how many controllable joints there are in this model.
+           * @return Returns what you asked for.
+           */
+          unsigned int
+          number_of_joints() const { return this->_numberOfJoints; }
+          
+          /**
+           * Get the coupled inertia matrix between the actuated joints and the base.
+           * @return An nx6 Eigen::Matrix object.
+           */
+          const JointBaseMatrix&
+          joint_base_inertia_matrix()
+          {
+               if(this->_jointBaseTermsAreOutdated) compute_joint_base_matrices();
+               return this->_jointBaseInertiaMatrix;
+          }
+          
+          /**
+           * Get the coupled inertia matrix between the base and actuated joints.
+           * @return A 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          base_joint_inertia_matrix() { return joint_base_inertia_matrix().transpose(); }
+          
+          /**
+           * Get the Coriolis matrix pertaining to coupled inertia between the actuated joints and base.
+           * @return An nx6 Eigen::Matrix object.
+           */
+          const JointBaseMatrix&
+          joint_base_coriolis_matrix()
+          {
+               if(this->_jointBaseTermsAreOutdated) compute_joint_base_matrices();
+               return this->_jointBaseCoriolisMatrix;
+          }
+          
+          /**
+           * Get the Coriolis matrix pertaining to coupled inertia between the base and actuated joints.
+           * @return A 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          base_joint_coriolis_matrix() { return -joint_base_coriolis_matrix().transpose(); }
+          
+          /**
+           * Get the inertia matrix in the joint space of the model / robot.
+           * @return Returns an nxn Eigen::Matrix object.
+           */            
+          const JointMatrix&
+          joint_inertia_matrix()
+          {
+               if(this->_inertiaMatrixIsOutdated) compute_joint_inertia_matrix();
+               return this->_jointInertiaMatrix;
+          }
+          
+          /**
+           * Solve M*X = B for the joint inertia matrix M of the current state, i.e. X = M^-1*B.
+           * M is factorised as L'*D*L along the branches of the tree, which is sparse for branching robots,
+           * so this costs O(n*d) for each column of B, where d is the depth of the tree.
+           * @param B An nxm matrix, or nx1 vector.
+           * @return The nxm matrix M^-1*B.
+           */
+          Eigen::MatrixXd
+          joint_inertia_solve(const Eigen::MatrixXd &B);
+          
+          /**
+           * Apply the inverse of the factor of the joint inertia matrix M = L'*L to a matrix, i.e. Y = L^-T*B.
+           * Then B'*M^-1*B = Y'*Y, which is useful for operational space inertia where B is the transpose of a Jacobian.
+           * @param B An nxm matrix, or nx1 vector.
+           * @return The nxm matrix L^-T*B, with its rows in joint order like B.
+           */
+          Eigen::MatrixXd
+          joint_inertia_factor_solve(const Eigen::MatrixXd &B);
+          
+          /**
+           * Get the matrix pertaining to centripetal and Coriolis torques in the joints of the model.
+           * @return Returns an nxn Eigen::Matrix object.
+           */
+          const JointMatrix&
+          joint_coriolis_matrix()
+          {
+               if(this->_coriolisMatrixIsOutdated) compute_joint_coriolis_matrix();
+               return this->_jointCoriolisMatrix;
+          }
+          
+          /**
+           * Get the centripetal and Coriolis torques in the joints of the model.
+           * This is computed in O(n) time with the recursive Newton-Euler algorithm, without forming the matrix.
+           * For a fixed base it equals joint_coriolis_matrix()*qdot. For a moving base the link velocities
+           * include the base twist, so it is the n joint rows of the full bias with zero joint and base
+           * acceleration, i.e. inverse_dynamics(q, qdot, 0) less damping and gravity. That includes the
+           * velocity terms that couple the joints to the base, which joint_coriolis_matrix()*qdot leaves
+           * out. The 6 rows for the force on the base are not returned.
+           * @return Returns an nx1 Eigen::Vector object.
+           */
+          const JointVector&
+          joint_coriolis_vector()
+          {
+               if(this->_coriolisVectorIsOutdated) compute_joint_coriolis_vector();
+               return this->_jointCoriolisVector;
+          }
+
+          /**
+           * Get the matrix that maps joint motion to Cartesian motion of the specified frame.
+           * @return Returns a 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          jacobian(const std::string &frameName); 
+          
+          /**
+           * Get the matrix that maps joint motion to Cartesian motion of a frame, without searching for it by name.
+           * @param frameID The number for the frame, from frame_id().
+           * @return Returns a 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          jacobian(const FrameID &frameID);
+
+          /**
+           * Compute the time derivative for a given Jacobian matrix.
+           * @param J The Jacobian for which to take the time derivative.
+           * @return A 6xn matrix for the time derivative.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          time_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix) const;
+          
+          /**
+           * Compute the time derivative of the Jacobian for a frame on the robot in preallocated memory.
+           * Like jacobian(frame, J), only the columns for the frame's supporting joints are written.
+           * @param frame A pointer to the reference frame on the model.
+           * @param jacobianDerivative A 6xn matrix in which to store the result.
+           */
+          void
+          jacobian_derivative(ReferenceFrame *frame,
+                              Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianDerivative) const;
+          
+          /**
+           * Compute the product of the Jacobian time derivative and joint velocities for a frame on the robot,
+           * i.e. the acceleration of the frame when the joints are not accelerating. This is O(n) and
+           * does not form the Jacobian derivative, so use it when only the product is needed.
+           * @param frame A pointer to the reference frame on the model.
+           * @return A 6x1 vector Jdot*qdot.
+           */
+          Eigen::Vector<double,6>
+          jacobian_derivative_product(ReferenceFrame *frame) const;
+          
+          /**
+           * Compute the operational space inertia Lambda = (J*M^-1*J')^-1 of a frame on the robot, for the current state.
+           * This uses the factorisation of the joint inertia matrix along the branches of the tree, so M is never inverted.
+           * @param frame A pointer to the reference frame on the model.
+           * @return A 6x6 matrix mapping the acceleration of the frame to the force on it.
+           */
+          Eigen::Matrix<double,6,6>
+          operational_space_inertia(ReferenceFrame *frame);
+          
+          /**
+           * Compute the operational space inertia for several frames at once, including the coupling between them.
+           * @param frames A list of pointers to reference frames on the model.
+           * @return A (6*k)x(6*k) matrix for k frames, with the blocks in the order of the list.
+           */
+          Eigen::MatrixXd
+          operational_space_inertia(const std::vector<ReferenceFrame*> &frames);
+          
+          /**
+           * Compute the inverse of the operational space inertia J*M^-1*J' for several frames.
+           * Unlike the operational space inertia, this is well defined at singularities.
+           * @param frames A list of pointers to reference frames on the model.
+           * @return A (6*k)x(6*k) matrix for k frames, with the blocks in the order of the list.
+           */
+          Eigen::MatrixXd
+          inverse_operational_space_inertia(const std::vector<ReferenceFrame*> &frames);
+          
+          /**
+           * Compute the dynamically consistent pseudoinverse M^-1*J'*Lambda of the Jacobian for a frame on the robot.
+           * @param frame A pointer to the reference frame on the model.
+           * @return An nx6 matrix.
+           */
+          Eigen::Matrix<double,Eigen::Dynamic,6>
+          dynamically_consistent_inverse(ReferenceFrame *frame);
+          
+          /**
+           * Compute the dynamically consistent pseudoinverse M^-1*J'*Lambda of the stacked Jacobians for several frames.
+           * @param frames A list of pointers to reference frames on the model.
+           * @return An nx(6*k) matrix for k frames.
+           */
+          Eigen::MatrixXd
+          dynamically_consistent_inverse(const std::vector<ReferenceFrame*> &frames);
+          
+          /**
+           * Compute the partial derivative for a Jacobian with respect to a given joint.
+           * @param J The Jacobian with which to take the derivative
+           * @param jointNumber The joint (link) number for which to take the derivative.
+           * @return A 6xn matrix for the partial derivative of the Jacobian.
+           */
+          Eigen::Matrix<double, 6, Eigen::Dynamic>
+          partial_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix,
+                             const unsigned int &jointNumber);
+
+          /**
+           * Get the pose of a specified reference frame on the kinematic tree.
+           * @return Returns a RobotLibrary::Pose object.
+           */
+          Pose
+          frame_pose(const std::string &frameName);
+          
+          /**
+           * Get the pose of a reference frame without searching for it by name.
+           * If the frame is cached, this is the pose computed by the last update_state().
+           * @param frameID The number for the frame, from frame_id().
+           * @return The pose of the frame relative to the global frame.
+           */
+          const Pose&
+          frame_pose(const FrameID &frameID);
+          
+          /**
+           * Get the number for a reference frame, so that it can be queried without searching by name.
+           * Look this up once, outside of any control loop.
+           * @param frameName In the URDF, the name of the link attached to a fixed joint.
+           * @return A number that can be passed to frame_pose() and jacobian().
+           */
+          FrameID
+          frame_id(const std::string &frameName) const;
+          
+          /**
+           * Compute the pose of a reference frame on every call to update_state(), so that
+           * frame_pose() only has to read it from memory.
+           * @param frameID The number for the frame, from frame_id().
+           * @return Returns false if the number is not a frame on this model.
+           */
+          bool
+          cache_frame_pose(const FrameID &frameID);
+          
+          /**
+           * Get the joint torques from viscous friction.
+           * @return An nx1 Eigen::Vector object
+           */
+          const JointVector&
+          joint_damping_vector() const { return this->_jointDampingVector; }
+               
+          /**
+           * Get the joint torques needed to oppose gravitational acceleration.
+           * @return Returns an nx1 Eigen::Vector object.
+           */   
+          const JointVector&
+          joint_gravity_vector()
+          {
+               if(this->_gravityVectorIsOutdated) compute_joint_gravity_vector();
+               return this->_jointGravityVector;
+          }
+          
+          /**
+           * Get the mass of the whole robot, including the base.
+           * @return The total mass (kg).
+           */
+          double
+          total_mass()
+          {
+               if(this->_centroidalTermsAreOutdated) compute_centroidal_terms();
+               return this->_totalMass;
+          }
+          
+          /**
+           * Get the position of the center of mass of the whole robot, including the base.
+           * @return A 3x1 vector in the base frame.
+           */
+          const Eigen::Vector3d&
+          center_of_mass()
+          {
+               if(this->_centroidalTermsAreOutdated) compute_centroidal_terms();
+               return this->_centerOfMassPosition;
+          }
+          
+          /**
+           * Get the Jacobian mapping joint velocities to the linear velocity of the center of mass of the whole robot.
+           * @return A 3xn Eigen::Matrix object.
+           */
+          const Eigen::Matrix<double,3,Eigen::Dynamic,Eigen::ColMajor,3,MaxJoints>&
+          center_of_mass_jacobian()
+          {
+               if(this->_centroidalTermsAreOutdated) compute_centroidal_terms();
+               return this->_centerOfMassJacobian;
+          }
+          
+          /**
+           * Get the centroidal momentum matrix, which maps joint velocities to the linear momentum of the
+           * whole robot and its angular momentum about the center of mass.
+           * @return A 6xn Eigen::Matrix object.
+           */
+          const JacobianMatrix&
+          centroidal_momentum_matrix()
+          {
+               if(this->_centroidalTermsAreOutdated) compute_centroidal_terms();
+               return this->_centroidalMomentumMatrix;
+          }
+          
+          /** 
+           * Get the current joint velocities of all the joints in the model.
+           * @return Returns an nx1 Eigen::Vector object.
+           */
+          const JointVector&
+          joint_velocities() const { return this->_jointVelocity; }
+          
+          /**
+           * Get the name of this model.
+           * @return Returns a std::string object.
+           */
+          std::string
+          name() const { return this->_name; }
+          
+          /**
+           * Returns a pointer to a reference frame on this model.
+           * @param name In the URDF, the name of the parent link attached to a fixed joint
+           * @return A ReferenceFrame data structure.
+           */
+          ReferenceFrame*
+          find_frame(const std::string &frameName);
+          
+          /**
+           * Returns a pointer to a reference frame on a shared, const model.
+           * @param name In the URDF, the name of the parent link attached to a fixed joint
+           * @return A ReferenceFrame data structure.
+           */
+          const ReferenceFrame*
+          find_frame(const std::string &frameName) const;
+          
+          /**
+           * Compute a matrix that relates joint motion to Cartesian motion for a frame on the robot.
+           * @param frame A pointer to the reference frame on the model.
+           * @return A 6xn Eigen::Matrix object.
+           */
+          Eigen::Matrix<double,6,Eigen::Dynamic>
+          jacobian(ReferenceFrame *frame);
+          
+          /**
+           * Compute the Jacobian for a frame on the robot in preallocated memory.
+           * Only the columns for the frame's supporting joints are written. The other columns are
+           * structurally zero, so the buffer only needs to be set to zero once before its first use.
+           * @param frame A pointer to the reference frame on the model.
+           * @param jacobianMatrix A 6xn matrix in which to store the result.
+           */
+          void
+          jacobian(ReferenceFrame *frame,
+                   Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const;
+          
+          /**
+           * Compute only the non-zero columns of the Jacobian for a frame on the robot.
+           * Column i corresponds to joint number frame->supportingJoints[i], so the cost
+           * depends on the depth of the frame in the tree rather than the number of joints.
+           * @param frame A pointer to the reference frame on the model.
+           * @param jacobianMatrix A 6xm matrix in which to store the result, where m = frame->supportingJoints.size().
+           */
+          void
+          compact_jacobian(ReferenceFrame *frame,
+                           Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const;
+          
+          /**
+           * Get the joint position vector in the underlying model.
+           * @return An nx1 Eigen::Vector object of all the joint positions.
+           */
+          const JointVector&
+          joint_positions() const { return this->_jointPosition; }
+          
+          /**
+           * Return a pointer to a link on the structure.
+           * @param The number of the link in the model.
+           * @return A RobotLibrary::Link object
+           */
+          Link*
+          link(const unsigned int &linkNumber);
+          
+          /**
+           * @param number The number for the joint in the model.
+           * @return A pointer to a RobotLibrary::Joint object
+           */
+          Joint
+          joint(const unsigned int &jointNumber) { return link(jointNumber)->joint(); }
+          
+          /**
+           * Compute the inertia, Coriolis, gravity, and base coupling terms every time update_state() is called.
+           * The Coriolis matrix is still only computed when requested, since most controllers need only the vector.
+           */
+          void use_eager_dynamics();
+          
+          /**
+           * Compute the inertia, Coriolis, gravity, and base coupling terms only when they are first requested
+           * after update_state() is called. Forward kinematics is always computed. This is the default.
+           */
+          void use_lazy_dynamics();
+          
+          /**
+           * Update the forward kinematics of independent branches of the tree (for example, the arms on a torso,
+           * the fingers on a hand, or the legs on a floating base) concurrently on separate threads.
+           * This only pays off for wide trees with long branches; see the README.
+           */
+          void use_parallel_kinematics();
+          
+          /**
+           * Update the forward kinematics one link at a time on the calling thread. This is the default.
+           */
+          void use_serial_kinematics();
+
+          RigidBody base;                                                                           ///< Specifies the dynamics for the base.
+          
+     private:
+          
+          enum UpdateMode {eager, lazy} _updateMode = lazy;                                         ///< Determines when the dynamics are computed.
+          
+          enum KinematicsMode {serial, parallel} _kinematicsMode = serial;                          ///< Determines how the forward kinematics is computed.
+          
+          bool _coriolisMatrixIsOutdated = true;                                                    ///< Joint Coriolis matrix must be recomputed.
+          
+          bool _coriolisVectorIsOutdated = true;                                                    ///< Joint Coriolis torques must be recomputed.
+          
+          bool _gravityVectorIsOutdated = true;                                                     ///< Joint gravity vector must be recomputed.
+          
+          bool _inertiaMatrixIsOutdated = true;                                                     ///< Joint inertia matrix must be recomputed.
+          
+          bool _inertiaFactorIsOutdated = true;                                                     ///< Factorisation of the inertia matrix must be recomputed.
+          
+          bool _jointBaseTermsAreOutdated = true;                                                   ///< Joint/base coupling matrices must be recomputed.
+          
+          bool _centroidalTermsAreOutdated = true;                                                  ///< Center of mass and centroidal momentum must be recomputed.
+          
+          double _totalMass = 0.0;                                                                  ///< Mass of the whole robot, including the base
+          
+          Eigen::Vector3d _centerOfMassPosition = {0,0,0};                                          ///< Center of mass of the whole robot
+          
+          Eigen::Matrix<double,3,Eigen::Dynamic,Eigen::ColMajor,3,MaxJoints> _centerOfMassJacobian;         ///< Maps joint velocities to the center of mass velocity
+          
+          JacobianMatrix _centroidalMomentumMatrix;                                                 ///< Maps joint velocities to momentum about the center of mass
+          
+          JointBaseMatrix _jointBaseCoriolisMatrix;                                                 ///< Inertial coupling between base and links
+          
+          JointBaseMatrix _jointBaseInertiaMatrix;                                                  ///< Inertial coupling between base and links
+          
+          JointMatrix _jointCoriolisMatrix;                                                         ///< As it says on the label.
+          
+          JointVector _jointCoriolisVector;                                                         ///< Coriolis matrix times joint velocities
+          
+          JointVector _jointDampingVector;                                                          ///< From viscous friction in the joints
+          
+          JointMatrix _jointInertiaMatrix;                                                          ///< As it says on the label.
+          
+          JointMatrix _jointInertiaFactor;                                                          ///< L'*D*L factors of the inertia matrix, in topological order
+
+          Eigen::Vector3d _gravityVector = {0,0,-9.81};                                             ///< 3x1 vector for the gravitational acceleration.
+               
+          JointVector _jointPosition;                                                               ///< A vector of all the joint positions.
+
+          JointVector _jointVelocity;                                                               ///< A vector of all the joint velocities.
+
+          JointVector _jointGravityVector;                                                          ///< A vector of all the gravitational joint torques.
+           
+          std::map<std::string, ReferenceFrame> _frameList;                                         ///< A dictionary of reference frames on the kinematic tree.
+          
+          std::vector<Link> _fullLinkList;                                                          ///< An array of all the links in the model, including fixed joints.
+          
+          std::vector<Link*> _link;                                                                 ///< An array of all the actuated links.
+          
+          std::vector<Link*> _baseLinks;                                                            ///< Array of links attached directly to the base.
+          
+          // Model properties, stored contiguously in topological order (every parent precedes its children)
+          
+          std::vector<int> _parentIndex;                                                            ///< Topological index of the parent of each link, or -1 for the base.
+          
+          std::vector<unsigned int> _jointNumber;                                                   ///< Joint number (position in the state vector) of each link.
+          
+          std::vector<unsigned int> _topologicalIndex;                                              ///< Topological index of each joint number.
+          
+          std::vector<bool> _isRevolute;                                                            ///< True for revolute joints, false for prismatic.
+          
+          std::vector<Pose> _jointOrigin;                                                           ///< Pose of each joint relative to its parent link.
+          
+          std::vector<Eigen::Vector3d> _localJointAxis;                                             ///< Axis of actuation in the local joint frame.
+          
+          std::vector<double> _linkMass;                                                            ///< Mass of each link.
+          
+          std::vector<Eigen::Matrix3d> _localInertia;                                               ///< Moment of inertia of each link in its local frame.
+          
+          std::vector<Eigen::Vector3d> _localCenterOfMass;                                          ///< Center of mass of each link in its local frame.
+          
+          std::vector<Eigen::Matrix3d> _originRotation;                                             ///< Rotation of each joint origin, as a matrix.
+          
+          std::vector<Eigen::Matrix3d> _originRotationAxis;                                         ///< Origin rotation times the skew-symmetric matrix of the joint axis.
+          
+          std::vector<Eigen::Matrix3d> _originRotationAxisSquared;                                  ///< Origin rotation times the square of the skew-symmetric matrix.
+          
+          // Link states, in topological order, computed on every call to update_state()
+          
+          std::vector<Pose> _linkPose;                                                              ///< Pose of each link in the base frame.
+          
+          std::vector<Eigen::Vector<double,6>> _linkTwist;                                          ///< Linear and angular velocity of each link.
+          
+          std::vector<Eigen::Vector3d> _jointAxis;                                                  ///< Axis of actuation in the base frame.
+          
+          std::vector<Eigen::Vector3d> _centerOfMass;                                               ///< Center of mass of each link in the base frame.
+          
+          std::vector<Eigen::Matrix3d> _linkInertia;                                                ///< Moment of inertia of each link in the base frame.
+          
+          std::vector<Joint> _joint;                                                                ///< A copy of the joint for every actuated link, indexed by number.
+          
+          KinematicTreeWorkspace _workspace;                                                        ///< Preallocated memory for intermediate calculations.
+          
+          std::string _name;                                                                        ///< A unique name for this model.
+          
+          unsigned int _numberOfJoints;                                                             ///< The number of actuated joint in the kinematic tree.
+          
+          unsigned int _numberOfThreads = std::max(1U, std::thread::hardware_concurrency());        ///< Size of the worker pool. Batches read it from the pool itself.
+          
+          std::shared_ptr<WorkerPool> _workerPool;                                                  ///< Threads for batches and parallel kinematics.
+          
+          std::vector<unsigned int> _trunk;                                                         ///< Topological indices of the links before the tree first branches.
+          
+          std::vector<std::vector<unsigned int>> _branches;                                         ///< Topological indices of each independent subtree after the trunk.
+          
+          std::vector<ReferenceFrame*> _frameHandle;                                                ///< Every reference frame, indexed by its number.
+          
+          std::vector<Pose> _framePose;                                                             ///< Pose of every reference frame, indexed by its number.
+          
+          std::vector<bool> _frameIsCached;                                                         ///< True if the pose of a frame is computed in update_state().
+          
+          std::vector<unsigned int> _cachedFrames;                                                  ///< Numbers of the frames computed in update_state().
+          
+          /**
+           * Computes the pose of a reference frame from the current link states.
+           * @param frameID The number for the frame.
+           */
+          void
+          update_frame_pose(const unsigned int &frameID);
+          
+          /**
+           * Computes the pose, velocity, and inertia of a single link from those of its parent.
+           * @param t The topological index of the link.
+           * @param basePose The pose of the base.
+           * @param baseTwist The velocity of the base.
+           */
+          void
+          update_link(const unsigned int            &t,
+                      const Pose                    &basePose,
+                      const Eigen::Vector<double,6> &baseTwist);
+                  
+          /**
+           * Computes the Jacobian to a given point on a given link.
+           * @param link A pointer to the link for the Jacobian
+           * @param point A point relative to the link with which to compute the Jacobian
+           * @param numberOfColumns Number of columns for the Jacobian (can be used to speed up calcs)
+           * @return A 6xn Jacobian matrix.
+           */
+          Eigen::Matrix<double,6,Eigen::Dynamic>
+          jacobian(Link *link,
+                   const Eigen::Vector3d &point,
+                   const unsigned int &numberOfColumns) const;
+          
+          /**
+           * Computes the Jacobian to a given point on a given link in preallocated memory.
+           * Columns for joints that are not between the link and the base are set to zero.
+           * @param index The topological index of the link for the Jacobian
+           * @param point A point relative to the link with which to compute the Jacobian
+           * @param jacobianMatrix Storage for the result. It must have more columns than the link number.
+           */
+          void
+          jacobian(const unsigned int &index,
+                   const Eigen::Vector3d &point,
+                   Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const;
+          
+          /**
+           * Computes the time derivative of a given Jacobian in preallocated memory.
+           * @param jacobianMatrix The Jacobian for which to take the time derivative.
+           * @param Jdot Storage for the result, of the same size as the Jacobian.
+           */
+          void
+          time_derivative(const Eigen::Ref<const Eigen::Matrix<double,6,Eigen::Dynamic>> &jacobianMatrix,
+                          Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> Jdot) const;
+          
+          /**
+           * Computes the time derivative of the Jacobian to a point moving with a given link.
+           * Each column is differentiated directly from the link velocities, so this is O(n) rather than O(n^2).
+           * Only columns for joints between the link and the base are written.
+           * @param index The topological index of the link for the Jacobian.
+           * @param point The point in the base frame.
+           * @param pointVelocity The linear velocity of the point in the base frame.
+           * @param jacobianDerivative Storage for the result. It must have more columns than the largest supporting joint number.
+           */
+          void
+          jacobian_derivative(const unsigned int &index,
+                              const Eigen::Vector3d &point,
+                              const Eigen::Vector3d &pointVelocity,
+                              Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianDerivative) const;
+
+          /**
+           * Computes the joint inertia matrix with the Composite Rigid Body Algorithm.
+           * Only the entries between each joint and its ancestors are filled, so branches
+           * that do not share a path to the base remain zero. Link states must be up to date.
+           */
+          void
+          compute_joint_inertia_matrix();
+          
+          /**
+           * Factorises the joint inertia matrix of the current state, if it is out of date.
+           */
+          void
+          update_joint_inertia_factor();
+          
+          /**
+           * Stacks the transposed Jacobians of several frames, for the operational space dynamics.
+           * @param frames A list of pointers to reference frames on the model.
+           * @return An nx(6*k) matrix for k frames.
+           */
+          Eigen::MatrixXd
+          stacked_jacobian_transpose(const std::vector<ReferenceFrame*> &frames) const;
+          
+          /**
+           * Factorises a joint inertia matrix as M = L'*D*L, where L is unit lower triangular in the topological order.
+           * Only entries between a joint and its ancestors are non-zero, so no fill-in occurs and this costs O(n*d^2),
+           * where d is the depth of the tree (Featherstone, 2008, Section 6.5).
+           * @param jointInertiaMatrix The nxn inertia matrix, with rows and columns in the order of the joint numbers.
+           * @param factor An nxn matrix in which to store D on the diagonal and L below it, in topological order.
+           */
+          void
+          factorise_joint_inertia(const Eigen::Ref<const Eigen::MatrixXd> &jointInertiaMatrix,
+                                  Eigen::Ref<Eigen::MatrixXd> factor) const;
+          
+          /**
+           * Overwrites X with M^-1*X, using the factors from factorise_joint_inertia().
+           * @param factor The L'*D*L factors of the inertia matrix, in topological order.
+           * @param X An nxm matrix with rows in topological order.
+           */
+          void
+          factored_inertia_solve(const Eigen::Ref<const Eigen::MatrixXd> &factor,
+                                 Eigen::Ref<Eigen::MatrixXd> X) const;
+          
+          /**
+           * Overwrites X with D^-1/2*L^-T*X, using the factors from factorise_joint_inertia().
+           * @param factor The L'*D*L factors of the inertia matrix, in topological order.
+           * @param X An nxm matrix with rows in topological order.
+           */
+          void
+          factored_inertia_root_solve(const Eigen::Ref<const Eigen::MatrixXd> &factor,
+                                      Eigen::Ref<Eigen::MatrixXd> X) const;
+          
+          /**
+           * Computes the joint Coriolis matrix from the current link states.
+           */
+          void
+          compute_joint_coriolis_matrix();
+          
+          /**
+           * Computes the joint Coriolis torques from the current link states.
+           */
+          void
+          compute_joint_coriolis_vector();
+          
+          /**
+           * Computes the joint torques needed to oppose gravity from the current link states.
+           */
+          void
+          compute_joint_gravity_vector();
+          
+          /**
+           * Computes the inertia and Coriolis coupling between the joints and the base from the current link states.
+           */
+          void
+          compute_joint_base_matrices();
+          
+          /**
+           * Computes the center of mass, its Jacobian, and the centroidal momentum matrix from the current link states.
+           */
+          void
+          compute_centroidal_terms();
+          
+          /**
+           * Gets the linear velocity of the center of mass of a link.
+           * @param index The topological index of the link.
+           * @return A 3x1 vector in the base frame.
+           */
+          Eigen::Vector3d
+          center_of_mass_velocity(const unsigned int &index) const
+          {
+               return this->_linkTwist[index].head<3>()
+                    + this->_linkTwist[index].tail<3>().cross(this->_centerOfMass[index] - this->_linkPose[index].translation());
+          }
+          
+          /**
+           * Gets the spatial acceleration of the base used in the recursive dynamics algorithms.
+           * Gravity is treated as a fictitious upward acceleration of the base.
+           * @return A 6x1 vector [linear ; angular].
+           */
+          Eigen::Vector<double,6>
+          base_acceleration() const
+          {
+               Eigen::Vector<double,6> acceleration = Eigen::Vector<double,6>::Zero();
+               acceleration.head(3) = -this->_gravityVector;
+               return acceleration;
+          }
+          
+          /**
+           * Fills the motionSubspace, velocity, and inertia fields of the model's own workspace
+           * from the current link states, so that update_state() need not repeat the forward kinematics.
+           */
+          void
+          compute_spatial_state();
+          
+          /**
+           * Computes the spatial joint axes, link velocities, and link inertias in the base frame
+           * for a given joint state, without altering the state of the model.
+           * The results are stored in the pose, motionSubspace, velocity, and inertia fields of the workspace.
+           * @param jointPosition A vector of the joint positions.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param basePose The pose of the base.
+           * @param baseTwist The velocity of the base.
+           * @param workspace Memory in which to store the results.
+           */
+          void
+          compute_spatial_kinematics(const Eigen::Ref<const Eigen::VectorXd> &jointPosition,
+                                     const Eigen::Ref<const Eigen::VectorXd> &jointVelocity,
+                                     const Pose                              &basePose,
+                                     const Eigen::Vector<double,6>           &baseTwist,
+                                     KinematicTreeWorkspace                  &workspace) const;
+          
+          /**
+           * Fills the inertia field of a workspace from the link poses already in it.
+           * @param workspace Memory holding the link poses.
+           */
+          void
+          compute_spatial_inertia(KinematicTreeWorkspace &workspace) const;
+          
+          /**
+           * Assembles the joint inertia matrix with the Composite Rigid Body Algorithm.
+           * The motionSubspace and inertia fields of the workspace must be filled beforehand.
+           * The inertia field is overwritten with the composite inertia of each subtree.
+           * @param workspace Memory holding the spatial joint axes and link inertias.
+           * @param jointInertiaMatrix An nxn matrix in which to store the result.
+           */
+          void
+          composite_rigid_body(KinematicTreeWorkspace &workspace,
+                               Eigen::Ref<Eigen::MatrixXd> jointInertiaMatrix) const;
+          
+          /**
+           * Computes joint torques with the recursive Newton-Euler algorithm.
+           * The motionSubspace, velocity, and inertia fields of the workspace must be filled beforehand
+           * by compute_spatial_kinematics().
+           * Joint friction is not included.
+           * @param jointVelocity A vector of the joint velocities.
+           * @param jointAcceleration A vector of the joint accelerations.
+           * @param baseAcceleration The spatial acceleration of the base, including gravity.
+           * @param workspace Memory holding the spatial joint axes, link velocities, and link inertias.
+           * @param jointTorque A vector in which to store the result.
+           */
+          void
+          recursive_newton_euler(const Eigen::Ref<const Eigen::VectorXd> &jointVelocity,
+                                 const Eigen::Ref<const Eigen::VectorXd> &jointAcceleration,
+                                 const Eigen::Vector<double,6> &baseAcceleration,
+                                 KinematicTreeWorkspace &workspace,
+                                 Eigen::Ref<Eigen::VectorXd> jointTorque) const;
+          
+          /**
+           * Differentiates the recursive Newton-Euler algorithm with respect to the joint positions and velocities.
+           * The workspace must hold the results of recursive_newton_euler() for the same joint state.
+           * @param workspace Memory holding the spatial joint axes, link velocities, accelerations, inertias, and subtree forces.
+           * @param torqueByPosition An nxn matrix in which to store d(tau)/dq.
+           * @param torqueByVelocity An nxn matrix in which to store d(tau)/d(qdot), excluding joint friction.
+           */
+          void
+          recursive_newton_euler_derivatives(KinematicTreeWorkspace &workspace,
+                                             Eigen::Ref<Eigen::MatrixXd> torqueByPosition,
+                                             Eigen::Ref<Eigen::MatrixXd> torqueByVelocity) const;
+          
+          /**
+           * Propagates the weight of each subtree toward the base and projects it on to the joint axes.
+           * @param jointPosition A vector of the joint positions.
+           * @param gravity The 3x1 gravitational acceleration in the base frame.
+           * @param basePose The pose of the base.
+           * @param pose Memory for the pose of each link, in topological order.
+           * @param axis Memory for the spatial axis of each joint, in topological order.
+           * @param force Memory for the weight of each subtree, in topological order.
+           * @param jointTorque An nx1 vector in which to store the result.
+           */
+          void
+          compute_gravity_torques(const Eigen::VectorXd &jointPosition,
+                                  const Eigen::Vector3d &gravity,
+                                  const Pose &basePose,
+                                  std::vector<Pose> &pose,
+                                  std::vector<Eigen::Vector<double,6>> &axis,
+                                  std::vector<Eigen::Vector<double,6>> &force,
+                                  Eigen::VectorXd &jointTorque) const;
+          
+          /**
+           * Splits a batch in to one contiguous range of configurations for each thread of the worker pool.
+           * Errors thrown by a thread are rethrown on the caller.
+           * @param numberOfConfigurations The number of configurations in the batch.
+           * @param range A function taking the first and one past the last configuration of a range.
+           */
+          void
+          split_batch(const unsigned int &numberOfConfigurations,
+                      const std::function<void(const unsigned int&, const unsigned int&)> &range) const;
+          
+          /**
+           * Evaluates a task for every configuration in a batch, split evenly across the worker pool.
+           * Use this for tasks that do not need a workspace, such as the forward kinematics.
+           * @param numberOfConfigurations The number of configurations in the batch.
+           * @param task A function taking the index of a configuration.
+           */
+          void
+          run_batch(const unsigned int &numberOfConfigurations,
+                    const std::function<void(const unsigned int&)> &task) const;
+          
+          /**
+           * Evaluates a task for every configuration in a batch, split evenly across the worker pool.
+           * Each thread has its own workspace, which is allocated once for its whole range.
+           * @param numberOfConfigurations The number of configurations in the batch.
+           * @param task A function taking a workspace and the index of a configuration.
+           */
+          void
+          run_batch(const unsigned int &numberOfConfigurations,
+                    const std::function<void(KinematicTreeWorkspace&, const unsigned int&)> &task) const;
+          
+          /**
+           * Computes the positions and rotations of links for a block of consecutive joint configurations,
+           * with one configuration in each lane so that every operation is a SIMD instruction.
+           * @param jointPositions An nxm matrix where each column is a joint configuration.
+           * @param firstColumn The first configuration in the block. Lanes past the end repeat the last one.
+           * @param links Topological indices of the links to compute, in ascending order, including their ancestors.
+           * @param linkPose The rotation (columns 0 to 8) and position (columns 9 to 11) of each link, in topological order.
+           */
+          template <int Lanes>
+          void
+          forward_kinematics_lanes(const Eigen::MatrixXd &jointPositions,
+                                   const unsigned int &firstColumn,
+                                   const std::vector<unsigned int> &links,
+                                   std::vector<Eigen::Array<double,Lanes,12>> &linkPose) const;
+          
+          /**
+           * Throws an error if a matrix of joint values does not have a row for every joint.
+           * @param functionName The name of the calling function, for the error message.
+           * @param jointValues An nxm matrix of joint values.
+           */
+          void
+          check_batch_dimensions(const std::string &functionName,
+                                 const Eigen::MatrixXd &jointValues) const;
+          
+          /**
+           * Converts a char array to a 3x1 vector. Used in the constructor.
+           * @param character A char array
+           * @return Returns a 3x1 Eigen vector object.
+           */
+          Eigen::Vector3d char_to_vector(const char* character);                      
+};                                                                                                  // Semicolon needed after class declarations
+
+}
+
+#endif
@@ -66,6 +66,20 @@ class Link : public RigidBody
                             const double                  &jointPosition,
                             const double                  &jointVelocity);
           
+          /**
+           * Sets the kinematic properties of the link when they have already been computed, e.g. by a KinematicTree.
+           * @param pose The pose of the link in the base frame.
+           * @param twist The linear and angular velocity of the link.
+           * @param jointAxis The axis of actuation in the base frame.
+           */
+          void set_state(const Pose                    &pose,
+                         const Eigen::Vector<double,6> &twist,
+                         const Eigen::Vector3d         &jointAxis)
+          {
+               RigidBody::update_state(pose, twist);
+               this->_jointAxis = jointAxis;
+          }
+          
           /**
            * Returns the Joint object associated with this link.
            */
@@ -82,7 +82,7 @@ class Pose
            * Apply a point transformation to a vector.
            */
           Eigen::Vector<double,3>
-          operator* (const Eigen::Vector<double,3> &other);
+          operator* (const Eigen::Vector<double,3> &other) const;
            
         private:
 
@@ -68,6 +68,16 @@ class RigidBody
            */
           Eigen::Vector3d center_of_mass() const { return this->_centerOfMass; }                    // Get the center of mass
           
+          /**
+           * @return The center of mass relative to the local reference frame of this object.
+           */
+          Eigen::Vector3d local_center_of_mass() const { return this->_localCenterOfMass; }
+          
+          /**
+           * @return The moment of inertia about the center of mass, in the local reference frame.
+           */
+          Eigen::Matrix3d local_inertia() const { return this->_localInertia; }
+          
           /**
            * @return The linear and angular velocity of this object.
            */
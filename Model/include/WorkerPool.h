@@ -0,0 +1,99 @@
+/**
+ * @file   WorkerPool.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  A set of persistent threads for evaluating independent tasks in parallel.
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <condition_variable>                                                                       // std::condition_variable
+#include <exception>                                                                                // std::exception_ptr
+#include <functional>                                                                               // std::function
+#include <mutex>                                                                                    // std::mutex
+#include <thread>                                                                                   // std::thread
+#include <vector>                                                                                   // std::vector
+
+namespace RobotLibrary {
+
+/**
+ * A pool of threads that are created once and reused, so that parallel work does not pay
+ * the cost of creating threads every time. The calling thread also takes part in the work.
+ */
+class WorkerPool
+{
+     public:
+          /**
+           * Constructor.
+           * @param numberOfThreads The total number of threads to use, including the calling thread.
+           */
+          WorkerPool(const unsigned int &numberOfThreads);
+
+          /**
+           * Destructor. Stops and joins all the threads.
+           */
+          ~WorkerPool();
+
+          WorkerPool(const WorkerPool&) = delete;                                                   // Threads cannot be copied
+
+          WorkerPool& operator=(const WorkerPool&) = delete;
+
+          /**
+           * Evaluates a number of independent tasks, and returns when all of them are finished.
+           * If any task throws an error, it is rethrown here after all the tasks have finished.
+           * Calls from different threads are evaluated one after the other.
+           * @param numberOfTasks The number of tasks to evaluate.
+           * @param task A function taking the index of a task.
+           */
+          void
+          run(const unsigned int &numberOfTasks,
+              const std::function<void(const unsigned int&)> &task);
+
+          /**
+           * @return The total number of threads, including the calling thread.
+           */
+          unsigned int
+          number_of_threads() const { return this->_threads.size() + 1; }
+
+     private:
+
+          bool _stop = false;                                                                       ///< Tells the threads to finish
+
+          const std::function<void(const unsigned int&)> *_task = nullptr;                          ///< The current task
+
+          unsigned int _numberOfTasks = 0;                                                          ///< Number of tasks in the current run
+
+          unsigned int _nextTask = 0;                                                               ///< Index of the next task to be started
+
+          unsigned int _unfinishedTasks = 0;                                                        ///< Number of tasks not yet completed
+
+          std::exception_ptr _error;                                                                ///< First error thrown by a task
+
+          std::mutex _mutex;                                                                        ///< Protects all of the above
+
+          std::mutex _runMutex;                                                                     ///< Stops two runs from overlapping
+
+          std::condition_variable _taskAvailable;                                                   ///< Wakes the threads when there is work
+
+          std::condition_variable _tasksFinished;                                                   ///< Wakes the caller when the work is done
+
+          std::vector<std::thread> _threads;                                                        ///< The worker threads
+
+          /**
+           * Takes tasks from the current run and evaluates them until none are left.
+           * @param lock A lock on _mutex, which is released while a task is evaluated.
+           */
+          void
+          evaluate_tasks(std::unique_lock<std::mutex> &lock);
+
+          /**
+           * The loop executed by each worker thread.
+           */
+          void
+          work();
+};                                                                                                  // Semicolon needed after a class declaration
+
+}
+
+#endif
@@ -82,7 +82,7 @@ Joint::Joint(const std::string             &name,
  //                       Get the local transform due to the joint position                       //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 Pose
-Joint::position_offset(const double &position)
+Joint::position_offset(const double &position) const
 {
      // Make sure the values are within the limits
      if(position > this->_positionLimit.upper)
@@ -6,10 +6,26 @@
  */
  
 #include "KinematicTree.h"
-#include <deque>
 
 namespace RobotLibrary {
 
+constexpr int BatchLanes = 4;                                                                       // Configurations evaluated at once by the batch kinematics
+
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+/**
+ * Forbids Eigen from allocating on the heap until it goes out of scope.
+ * The previous setting is restored in the destructor, so it still happens if an error is thrown.
+ */
+struct NoMallocScope
+{
+     NoMallocScope() : wasAllowed(Eigen::internal::is_malloc_allowed()) { Eigen::internal::set_is_malloc_allowed(false); }
+     
+     ~NoMallocScope() { Eigen::internal::set_is_malloc_allowed(this->wasAllowed); }
+     
+     bool wasAllowed;                                                                               ///< Setting before this scope
+};
+#endif
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                                        Constructor                                            //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -242,7 +258,7 @@ KinematicTree::KinematicTree(const std::string &pathToURDF)
                }
                else parentLink->merge(currentLink);                                                 // Merge this link in to the previous
           
-               ReferenceFrame frame = {parentLink, currentLink.joint().origin()};
+               ReferenceFrame frame = {parentLink, currentLink.joint().origin(), {}};                // Supporting joints are found later
                
                this->_frameList.emplace(currentLink.name(),frame);                                   // Save this link as a reference frame so we can search it later
           }
@@ -257,15 +273,117 @@ KinematicTree::KinematicTree(const std::string &pathToURDF)
      
      this->_numberOfJoints = this->_link.size();
      
+     if(MaxJoints != Eigen::Dynamic and this->_numberOfJoints > (unsigned int)MaxJoints)
+     {
+          throw runtime_error("[ERROR] [KINEMATIC TREE] Constructor: "
+                              "The model has " + std::to_string(this->_numberOfJoints) + " joints, "
+                                      "but this library was compiled with a maximum of " + std::to_string(MaxJoints) + ".");
+     }
+     
+     // Sort the links so that parents always precede their children (breadth-first from the base)
+     std::vector<Link*> orderedLinks = this->_baseLinks;
+     for(unsigned int i = 0; i < orderedLinks.size(); ++i)
+     {
+          for(auto childLink : orderedLinks[i]->child_links()) orderedLinks.push_back(childLink);
+     }
+     
+     // Copy the model properties in to contiguous arrays in this order
+     this->_topologicalIndex.resize(this->_numberOfJoints);
+     for(unsigned int t = 0; t < orderedLinks.size(); ++t) this->_topologicalIndex[orderedLinks[t]->number()] = t;
+     
+     for(Link *currentLink : orderedLinks)
+     {
+          Joint joint = currentLink->joint();
+          
+          this->_jointNumber.push_back(currentLink->number());
+          this->_parentIndex.push_back(currentLink->parent_link() == nullptr ? -1 : (int)this->_topologicalIndex[currentLink->parent_link()->number()]);
+          this->_isRevolute.push_back(joint.is_revolute());
+          this->_jointOrigin.push_back(joint.origin());
+          this->_localJointAxis.push_back(joint.axis());
+          this->_linkMass.push_back(currentLink->mass());
+          this->_localInertia.push_back(currentLink->local_inertia());
+          this->_localCenterOfMass.push_back(currentLink->local_center_of_mass());
+          
+          // Rodrigues' formula R(q) = I + sin(q)*K + (1 - cos(q))*K^2 lets the batch kinematics rotate without quaternions
+          Eigen::Vector3d axis = joint.axis();
+          Eigen::Matrix3d K;
+          K <<       0, -axis(2),  axis(1),
+               axis(2),        0, -axis(0),
+              -axis(1),  axis(0),        0;
+          
+          this->_originRotation.push_back(joint.origin().rotation());
+          this->_originRotationAxis.push_back(this->_originRotation.back()*K);
+          this->_originRotationAxisSquared.push_back(this->_originRotationAxis.back()*K);
+     }
+     
+     this->_linkPose.resize(this->_numberOfJoints);
+     this->_linkTwist.resize(this->_numberOfJoints);
+     this->_jointAxis.resize(this->_numberOfJoints);
+     this->_centerOfMass.resize(this->_numberOfJoints);
+     this->_linkInertia.resize(this->_numberOfJoints);
+     
+     // Record the joints that move each reference frame, so Jacobians only need to visit these
+     for(auto &[name, frame] : this->_frameList)
+     {
+          for(Link *link = frame.link; link != nullptr; link = link->parent_link())
+          {
+               frame.supportingJoints.insert(frame.supportingJoints.begin(), link->number());
+          }
+          
+          this->_frameHandle.push_back(&frame);                                                     // Number the frames, so they can be found without a search
+     }
+     
+     this->_framePose.resize(this->_frameHandle.size());
+     this->_frameIsCached.resize(this->_frameHandle.size(), false);
+     
+     // Partition the tree in to a serial trunk, and the independent subtrees that branch from it
+     std::vector<unsigned int> roots;
+     for(Link *baseLink : this->_baseLinks) roots.push_back(this->_topologicalIndex[baseLink->number()]);
+     
+     while(roots.size() == 1)                                                                       // Not yet branched
+     {
+          this->_trunk.push_back(roots.front());
+          
+          std::vector<unsigned int> children;
+          for(Link *childLink : orderedLinks[roots.front()]->child_links()) children.push_back(this->_topologicalIndex[childLink->number()]);
+          
+          roots = children;
+     }
+     
+     this->_branches.resize(roots.size());
+     
+     std::vector<int> branchNumber(this->_numberOfJoints, -1);                                      // Which branch each link belongs to
+     
+     for(unsigned int k = 0; k < roots.size(); ++k) branchNumber[roots[k]] = k;
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)                                        // Parents precede children, so a single sweep will do
+     {
+          int p = this->_parentIndex[t];
+          
+          if(branchNumber[t] < 0 and p >= 0) branchNumber[t] = branchNumber[p];
+          
+          if(branchNumber[t] >= 0) this->_branches[branchNumber[t]].push_back(t);
+     }
+     
+     this->_workerPool = std::make_shared<WorkerPool>(this->_numberOfThreads);
+     
      // Resize the relevant matrices, vectors accordingly
      this->_jointPosition.resize(this->_numberOfJoints);
      this->_jointVelocity.resize(this->_numberOfJoints);
      this->_jointInertiaMatrix.resize(this->_numberOfJoints, this->_numberOfJoints);
+     this->_jointInertiaFactor.resize(this->_numberOfJoints, this->_numberOfJoints);
      this->_jointCoriolisMatrix.resize(this->_numberOfJoints, this->_numberOfJoints);
+     this->_jointCoriolisVector.resize(this->_numberOfJoints);
      this->_jointDampingVector.resize(this->_numberOfJoints);
      this->_jointGravityVector.resize(this->_numberOfJoints);
      this->_jointBaseInertiaMatrix.resize(this->_numberOfJoints, NoChange);
      this->_jointBaseCoriolisMatrix.resize(this->_numberOfJoints, NoChange);
+     this->_centerOfMassJacobian.resize(NoChange, this->_numberOfJoints);
+     this->_centroidalMomentumMatrix.resize(NoChange, this->_numberOfJoints);
+     this->_workspace.resize(this->_numberOfJoints);
+     
+     // Keep a copy of the joints so they can be queried without copying from the links
+     for(Link *currentLink : this->_link) this->_joint.push_back(currentLink->joint());
      
      std::cout << "[INFO] [KINEMATIC TREE] Successfully generated the '" << this->_name << "' robot model."
                << " It has " << this->_numberOfJoints << " joints (reduced from " << this->_fullLinkList.size() << ")." << std::endl;
@@ -317,309 +435,2128 @@ bool KinematicTree::update_state(const Eigen::VectorXd &jointPosition,
         return false;
     }
     
+    #ifdef EIGEN_RUNTIME_NO_MALLOC
+        NoMallocScope noMalloc;                                                                     // Eigen will assert if this tick allocates memory
+    #endif
+    
     this->_jointPosition = jointPosition;    
     this->_jointVelocity = jointVelocity;    
     this->base.update_state(basePose, baseTwist);
     
-    // Clear matrices
-    this->_jointInertiaMatrix.setZero();
-    this->_jointCoriolisMatrix.setZero();
-    this->_jointGravityVector.setZero();
-    this->_jointBaseInertiaMatrix.setZero();
-    this->_jointBaseCoriolisMatrix.setZero();
-    
-    std::deque<Link*> candidateList(this->_baseLinks.begin(), this->_baseLinks.end());
-    
-    while(not candidateList.empty())
+    // Forward kinematics is always computed. Parents precede their children, so this is a single sweep.
+    if(this->_kinematicsMode == serial or this->_branches.size() < 2)
     {
-        Link *currentLink = candidateList.back();
-        candidateList.pop_back();
-        
-        unsigned int k = currentLink->number();
-        Link *parentLink = currentLink->parent_link();
-        
-        bool success = parentLink == nullptr 
-                       ? currentLink->update_state(this->base.pose(), this->base.twist(), jointPosition(k), jointVelocity(k))
-                       : currentLink->update_state(jointPosition(k), jointVelocity(k));
-        
-        if(not success)
-        {
-            std::cerr << "[ERROR] [KINEMATIC TREE] update_state(): "
-                      << "Unable to update the state for the '" << currentLink->name()
-                      << "' link (" << currentLink->joint().name() << " joint).\n";
-                      
-            return false;
-        }
-        
-        Eigen::Matrix<double,6,Eigen::Dynamic> J = jacobian(currentLink, currentLink->center_of_mass(), k+1);
-        Eigen::Matrix<double,3,Eigen::Dynamic> Jv = J.block(0,0,3,k+1);
-        Eigen::Matrix<double,3,Eigen::Dynamic> Jw = J.block(3,0,3,k+1);
+        for(unsigned int t = 0; t < this->_numberOfJoints; ++t) update_link(t, basePose, baseTwist);
+    }
+    else
+    {
+        for(unsigned int t : this->_trunk) update_link(t, basePose, baseTwist);
         
-        double mass = currentLink->mass();
+        // Branches only read from the trunk, and write to their own links, so they can be done concurrently.
+        // The pool returns once every branch is finished, so the dynamics below see the whole tree.
+        std::shared_ptr<WorkerPool> workerPool = std::atomic_load(&this->_workerPool);             // Held until the branches are done
         
-        for(int i = 0; i < k+1; ++i)
+        workerPool->run(this->_branches.size(), [this](const unsigned int &k)
         {
-            for(int j = i; j < k+1; ++j)
-            {
-                this->_jointInertiaMatrix(i,j) += mass * Jv.col(i).dot(Jv.col(j))
-                                                + Jw.col(i).dot(currentLink->inertia() * Jw.col(j));
-            }
-        }
-        
-        Eigen::Matrix<double,6,Eigen::Dynamic> Jdot = time_derivative(J);
-        
-        this->_jointCoriolisMatrix.block(0,0,k+1,k+1) += mass * Jv.transpose() * Jdot.block(0,0,3,k+1)
-                                                       + Jw.transpose() * (currentLink->inertia_derivative() * Jw + currentLink->inertia() * Jdot.block(3,0,3,k+1));
-        
-        this->_jointGravityVector.head(k+1) -= mass * Jv.transpose() * this->_gravityVector;
-        this->_jointDampingVector[k] = currentLink->joint().damping() * this->_jointVelocity[k];
-        
-        this->_jointBaseInertiaMatrix.block(0,0,k+1,3) += mass * Jv.transpose();
-        this->_jointBaseInertiaMatrix.block(0,3,k+1,3) += Jw.transpose() * this->base.inertia()
-                                                        - mass * (SkewSymmetric(currentLink->center_of_mass() - this->base.pose().translation()) * Jv).transpose();
-        
-        this->_jointBaseCoriolisMatrix.block(0,3,k+1,3) += Jw.transpose() * this->base.inertia_derivative()
-                                                         - mass * (SkewSymmetric(currentLink->twist().head(3)) * Jv).transpose();
-        
-        std::vector<Link*> temp = currentLink->child_links();
-        if(not temp.empty()) candidateList.insert(candidateList.begin(), temp.begin(), temp.end());
+            Pose                    basePose  = this->base.pose();                                  // Captured via the base so the task fits std::function without allocating
+            Eigen::Vector<double,6> baseTwist = this->base.twist();
+            
+            for(unsigned int t : this->_branches[k]) update_link(t, basePose, baseTwist);
+        });
     }
     
-    for(int i = 1; i < this->_numberOfJoints; ++i)
+    for(unsigned int frameID : this->_cachedFrames) update_frame_pose(frameID);                   // So frame_pose() is just a memory read
+    
+    // Flag the dynamics as out of date so they are recomputed on request
+    this->_coriolisMatrixIsOutdated  = true;
+    this->_coriolisVectorIsOutdated  = true;
+    this->_gravityVectorIsOutdated   = true;
+    this->_inertiaMatrixIsOutdated   = true;
+    this->_inertiaFactorIsOutdated   = true;
+    this->_jointBaseTermsAreOutdated = true;
+    this->_centroidalTermsAreOutdated = true;
+    
+    if(this->_updateMode == eager)
     {
-        for(int j = 0; j < i; ++j) this->_jointInertiaMatrix(i,j) = this->_jointInertiaMatrix(j,i);
+        compute_joint_inertia_matrix();
+        compute_joint_coriolis_vector();
+        compute_joint_gravity_vector();
+        compute_joint_base_matrices();
+        compute_centroidal_terms();
     }
     
     return true;
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                   Compute the Jacobian to the specified reference frame                        //
+ //                       Compute the state of a single link from its parent                       //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double,6,Eigen::Dynamic>
-KinematicTree::jacobian(ReferenceFrame *frame)
+void
+KinematicTree::update_link(const unsigned int            &t,
+                           const Pose                    &basePose,
+                           const Eigen::Vector<double,6> &baseTwist)
 {
-    if(frame == nullptr)
-    {
-        throw std::runtime_error("[ERROR] [KINEMATIC TREE] jacobian(): "
-                                 "Pointer to reference frame was empty.");
-    }
-
-    else
-    {
-        return jacobian(frame->link,
-                       (frame->link->pose()*frame->relativePose).translation(),
-                        this->_numberOfJoints);
-    }
+    unsigned int i = this->_jointNumber[t];
+    int          p = this->_parentIndex[t];
+    
+    const Pose                    &parentPose  = (p < 0) ? basePose  : this->_linkPose[p];
+    const Eigen::Vector<double,6> &parentTwist = (p < 0) ? baseTwist : this->_linkTwist[p];
+    
+    Pose &pose = this->_linkPose[t];
+    
+    pose = parentPose*this->_jointOrigin[t];                                                        // Pose of the joint in the base frame
+    
+    this->_jointAxis[t] = (pose.rotation()*this->_localJointAxis[t]).normalized();                  // Axis of actuation in the base frame
+    
+    pose *= this->_joint[i].position_offset(this->_jointPosition(i));                               // NOTE: This can throw an error!
+    
+    Eigen::Vector<double,6> &twist = this->_linkTwist[t];
+    
+    twist = parentTwist;
+    twist.head(3) += parentTwist.tail<3>().cross(pose.translation() - parentPose.translation());
+    
+    if(this->_isRevolute[t]) twist.tail(3) += this->_jointVelocity(i)*this->_jointAxis[t];
+    else                     twist.head(3) += this->_jointVelocity(i)*this->_jointAxis[t];
+    
+    Eigen::Matrix3d R = pose.rotation();
+    
+    this->_centerOfMass[t] = pose*this->_localCenterOfMass[t];
+    this->_linkInertia[t]  = R*this->_localInertia[t]*R.transpose();
+    
+    this->_link[i]->set_state(pose, twist, this->_jointAxis[t]);                                    // Keep the link objects consistent
+    
+    this->_jointDampingVector[i] = this->_joint[i].damping() * this->_jointVelocity(i);
 }
 
-  ///////////////////////////////////////////////////////////////////////////////////////////////////
- //                            Compute the Jacobian to a given point                              //
-///////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double, 6, Eigen::Dynamic>
-KinematicTree::jacobian(Link *link,                                                                 // Starting point in the kinematic tree
-                        const Eigen::Vector3d &point,                                               // A point in the given joint frame
-                        const unsigned int    &numberOfColumns)                                     // Must be less than or equal to number of joints in model
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                          Create memory for the state of one thread                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+KinematicTreeData
+KinematicTree::make_data() const
 {
-     // Whitney, D. E. (1972)
-     // "The mathematics of coordinated control of prosthetic arms and manipulators"
-     // Journal of Dynamic Systems, Measurement, and Control, pp. 303-309
+     KinematicTreeData data;
      
-     Eigen::Matrix<double,6,Eigen::Dynamic> J(6,numberOfColumns); J.setZero();
+     data.resize(this->_numberOfJoints);
      
-     if(link->number() > numberOfColumns)
-     {
-          throw std::logic_error("[ERROR] [KINEMATIC TREE] jacobian(): "
-                                 "Cannot compute a Jacobian with " + std::to_string(numberOfColumns) +
-                                 "columns using " + std::to_string(link->number()+1) + " joints.");
-     }
-     else if(numberOfColumns > this->_numberOfJoints)
-     {
-          throw std::logic_error("[ERROR] [KINEMATIC TREE] jacobian(): "
-                                 "A Jacobian matrix with " + std::to_string(numberOfColumns) + " columns was requested, "
-                                 "but this model has only " + std::to_string(this->_numberOfJoints) + " joints.");
-     }
-     else
-     {
-          while(link != nullptr)
-          {
-               unsigned int i = link->number();
-          
-               if(link->joint().is_revolute())
-               {
-                    // J_i = [ a_i x r_i ]
-                    //       [    a_i    ]
-               
-                    J.block(0,i,3,1) = link->joint_axis().cross(point - link->pose().translation()); // Linear component
-                    J.block(3,i,3,1) = link->joint_axis();                                           // Angular component
-               }
-               else // prismatic
-               {
-                    // J_i = [ a_i ]
-                    //       [  0  ]
-                    
-                    J.block(0,i,3,1) = link->joint_axis();                                          // Linear component
-                    J.block(3,i,3,1).setZero();                                                     // Angular component
-               }
-               
-               link = link->parent_link();                                                          // Move to next joint toward the base     
-          }
-     }
-     return J;
+     data.basePose  = this->base.pose();
+     data.baseTwist = this->base.twist();
+     data.gravity   = this->_gravityVector;
+     
+     return data;
 }
 
-  ///////////////////////////////////////////////////////////////////////////////////////////////////
- //                         Get the time derivative of a given Jacobian                           //
-///////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double, 6, Eigen::Dynamic>
-KinematicTree::time_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix)
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Update the kinematics for one thread without altering the model                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::update_state(const Eigen::VectorXd         &jointPosition,
+                            const Eigen::VectorXd         &jointVelocity,
+                            const Pose                    &basePose,
+                            const Eigen::Vector<double,6> &baseTwist,
+                            KinematicTreeData             &data) const
 {
-
-     // An algorithm for computing the time derivative is provided in this reference,
-     // but it's not the same as this one:
-     // Angeles, J. (2003) "Fundamentals of Robotic Mechanical Systems: Theory, Methods, and Algorithms"
-     // Springer
-     
-     Eigen::Matrix<double,6,Eigen::Dynamic> Jdot(6,jacobianMatrix.cols());
-     Jdot.setZero();
-
-     for(int i = 0; i < jacobianMatrix.cols(); ++i)
+     if(data.workspace.pose.size() != this->_numberOfJoints)
      {
-          for(int j = 0; j <= i; ++j)
-          {
-               // Compute dJ(i)/dq(j)
-               if(this->_link[j]->joint().is_revolute())
-               {
-                    double qdot = this->_jointVelocity(j);                                          // Makes things a little easier
-                    
-                    // qdot_j * ( a_j x (a_i x r_i) )
-                    Jdot(0,i) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i));
-                    Jdot(1,i) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i));
-                    Jdot(2,i) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i));
-                    
-                    if(this->_link[i]->joint().is_revolute())                                       // J_i = [a_i x r_i; a_i]
-                    {
-                         // qdot_j * ( a_j x a_i )
-                         Jdot(3,i) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(5,i) - jacobianMatrix(5,j)*jacobianMatrix(4,i));
-                         Jdot(4,i) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(3,i) - jacobianMatrix(3,j)*jacobianMatrix(5,i));
-                         Jdot(5,i) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(4,i) - jacobianMatrix(4,j)*jacobianMatrix(3,i));
-                    }     
-               }
-               
-               // Compute dJ(j)/dq(i)
-               if(i != j and this->_link[j]->joint().is_revolute())                                 // J_j = [a_j x r_j; a_j]
-               {
-                    double qdot = this->_jointVelocity(i);                                          // Makes things a little easier
-                    
-                    if(this->_link[i]->joint().is_revolute())                                       // J_i = [a_i x r_i; a_i]
-                    {
-                         // qdot_i * ( a_i x (a_j x r_j) )
-                         Jdot(0,j) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i));
-                         Jdot(1,j) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i));
-                         Jdot(2,j) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i));
-                    }
-                    else // this->link[i]->joint().is_prismatic()                                   // J_i = [a_i ; 0]
-                    {
-                         // qdot_i * ( a_i x (a_j x r_j) )
-                         Jdot(0,j) += qdot*(jacobianMatrix(1,i)*jacobianMatrix(2,j) - jacobianMatrix(2,i)*jacobianMatrix(1,j));
-                         Jdot(1,j) += qdot*(jacobianMatrix(2,i)*jacobianMatrix(0,j) - jacobianMatrix(0,i)*jacobianMatrix(2,j));
-                         Jdot(2,j) += qdot*(jacobianMatrix(0,i)*jacobianMatrix(1,j) - jacobianMatrix(1,i)*jacobianMatrix(0,j));
-                    }
-               }
-          }
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] update_state(): "
+                                      "The data was not made for this model. Use make_data() to create it.");
      }
-          
-     return Jdot;
+     
+     compute_spatial_kinematics(jointPosition, jointVelocity, basePose, baseTwist, data.workspace); // NOTE: This can throw an error!
+     
+     data.jointPosition = jointPosition;
+     data.jointVelocity = jointVelocity;
+     data.basePose      = basePose;                                                                 // In case they are not the data's own
+     data.baseTwist     = baseTwist;
 }
 
-  ///////////////////////////////////////////////////////////////////////////////////////////////////
- //             Get the partial derivative of a Jacobian with respect to a given joint            //
-///////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double, 6, Eigen::Dynamic>
-KinematicTree::partial_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix,
-                                  const unsigned int &jointNumber)
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Get the pose of a frame from the state of one thread                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Pose
+KinematicTree::frame_pose(const ReferenceFrame *frame, const KinematicTreeData &data) const
 {
-
-     // E. D. Pohl and H. Lipkin, "A new method of robotic rate control near singularities,"
-     // Proceedings. 1991 IEEE International Conference on Robotics and Automation,
-     // 1991, pp. 1708-1713 vol.2, doi: 10.1109/ROBOT.1991.131866.
-     
-     unsigned int numberOfColumns = jacobianMatrix.cols();
-     
-     if(jointNumber >= numberOfColumns)
+     if(frame == nullptr)
      {
-          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] partial_derivative(): "
-                                      "Cannot take the derivative with respect to joint number "
-                                      + std::to_string(jointNumber) + " for a Jacobian with only "
-                                      + std::to_string(numberOfColumns) + " columns.");
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] frame_pose(): "
+                                   "Pointer to reference frame was empty.");
      }
+     
+     if(frame->link == nullptr) return data.basePose*frame->relativePose;                           // Frame is on the base
+     
+     return data.workspace.pose[this->_topologicalIndex[frame->link->number()]]*frame->relativePose;
+}
 
-     Eigen::Matrix<double,6,Eigen::Dynamic> dJ(6,numberOfColumns);                                  // Value to be returned
-     dJ.setZero();
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Compute the Jacobian of a frame from the state of one thread               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,Eigen::Dynamic>
+KinematicTree::jacobian(const ReferenceFrame *frame, const KinematicTreeData &data) const
+{
+     Eigen::Vector3d point = frame_pose(frame, data).translation();                                 // NOTE: This can throw an error!
      
-     int j = jointNumber;                                                                           // Makes things a little easier
+     Eigen::Matrix<double,6,Eigen::Dynamic> jacobianMatrix = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,this->_numberOfJoints);
      
-     for(int i = 0; i < numberOfColumns-1; ++i)
+     for(const unsigned int &j : frame->supportingJoints)
      {
-          if(this->_link[i]->joint().is_revolute())                                                 // J_i = [a_i x r_i ; a_i]
-          {
-               if(this->_link[j]->joint().is_revolute())                                            // J_i = [a_j x r_j; a_j]
-               {
-                    if (j < i)
-                    {
-                         // a_j x (a_i x a_i)
-                         dJ(0,i) = jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i);
-                         dJ(1,i) = jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i);
-                         dJ(2,i) = jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i);
-
-                         // a_j x a_i
-                         dJ(3,i) = jacobianMatrix(4,j)*jacobianMatrix(5,i) - jacobianMatrix(5,j)*jacobianMatrix(4,i);
-                         dJ(4,i) = jacobianMatrix(5,j)*jacobianMatrix(3,i) - jacobianMatrix(3,j)*jacobianMatrix(5,i);
-                         dJ(5,i) = jacobianMatrix(3,j)*jacobianMatrix(4,i) - jacobianMatrix(4,j)*jacobianMatrix(3,i);
-                    }
-                    else
-                    {
-                         // a_i x (a_j x a_j)
-                         dJ(0,i) = jacobianMatrix(4,i)*jacobianMatrix(2,j) - jacobianMatrix(5,i)*jacobianMatrix(1,j);
-                         dJ(1,i) = jacobianMatrix(5,i)*jacobianMatrix(0,j) - jacobianMatrix(3,i)*jacobianMatrix(2,j);
-                         dJ(2,i) = jacobianMatrix(3,i)*jacobianMatrix(1,j) - jacobianMatrix(4,i)*jacobianMatrix(0,j);
-                    }
-               }
-               else if(this->_link[j]->joint().is_prismatic() and j > i)                            // J_j = [a_j ; 0]
-               {
-                    // a_j x a_i
-                    dJ(0,i) = jacobianMatrix(1,j)*jacobianMatrix(2,i) - jacobianMatrix(2,j)*jacobianMatrix(1,i);
-                    dJ(1,i) = jacobianMatrix(2,j)*jacobianMatrix(0,i) - jacobianMatrix(0,j)*jacobianMatrix(2,i);
-                    dJ(2,i) = jacobianMatrix(0,j)*jacobianMatrix(1,i) - jacobianMatrix(1,j)*jacobianMatrix(0,i);
-               }
-          }
-          else if(this->_link[i]->joint().is_prismatic()                                            // J_i = [a_i ; 0]
-              and this->_link[j]->joint().is_revolute()                                             // J_j = [a_j x r_j; a_j]
-              and j < i)
-          {
-               // a_j x a_i
-               dJ(0,i) = jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i);
-               dJ(1,i) = jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i);
-               dJ(2,i) = jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i);
-          }
+          const Eigen::Vector<double,6> &axis = data.workspace.motionSubspace[this->_topologicalIndex[j]];
+          
+          // Shift the spatial joint axis from the global origin to the point
+          jacobianMatrix.block(0,j,3,1) = axis.head<3>() + axis.tail<3>().cross(point);
+          jacobianMatrix.block(3,j,3,1) = axis.tail<3>();
      }
      
-     return dJ;
+     return jacobianMatrix;
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                         Compute the Jacobian to a given frame                                  //
+ //                  Compute the joint inertia matrix from the state of one thread                 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double,6,Eigen::Dynamic>
-KinematicTree::jacobian(const std::string &frameName)
+const JointMatrix&
+KinematicTree::joint_inertia_matrix(KinematicTreeData &data) const
 {
-     return jacobian(find_frame(frameName));                                                        // Too easy lol ᕙ(▀̿̿ĺ̯̿̿▀̿ ̿) ᕗ
+     composite_rigid_body(data.workspace, data.jointInertiaMatrix);
+     
+     compute_spatial_inertia(data.workspace);                                                       // Undo the composite inertias, for inverse_dynamics()
+     
+     return data.jointInertiaMatrix;
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                         Get the pose of a reference frame on the robot                         //
+ //                  Compute the inverse dynamics from the state of one thread                     //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Pose
+Eigen::VectorXd
+KinematicTree::inverse_dynamics(const Eigen::VectorXd &jointAcceleration, KinematicTreeData &data) const
+{
+     if(jointAcceleration.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] inverse_dynamics(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the acceleration argument had " + std::to_string(jointAcceleration.size()) + " elements.");
+     }
+     
+     Eigen::VectorXd jointTorque(this->_numberOfJoints);                                            // Value to be returned
+     
+     Eigen::Vector<double,6> baseAcceleration = data.baseAcceleration;                              // Of this thread, not the model
+     
+     baseAcceleration.head(3) -= data.gravity;                                                      // Accelerating the base upward is equivalent to gravity
+     
+     recursive_newton_euler(data.jointVelocity, jointAcceleration, baseAcceleration, data.workspace, jointTorque);
+     
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i)
+     {
+          jointTorque(i) += this->_joint[i].damping()*data.jointVelocity(i);                        // Add viscous friction
+     }
+     
+     return jointTorque;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Compute the matrix of centripetal and Coriolis effects                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_joint_coriolis_matrix()
+{
+    // NOTE: Products are evaluated lazily in to preallocated memory so that this does not allocate.
+    
+    this->_jointCoriolisMatrix.setZero();
+    
+    for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+    {
+        unsigned int k = this->_jointNumber[t];
+        
+        auto J    = this->_workspace.jacobian.leftCols(k+1);
+        auto Jdot = this->_workspace.jacobianDerivative.leftCols(k+1);
+        auto temp = this->_workspace.product.leftCols(k+1);
+        
+        jacobian(t, this->_centerOfMass[t], J);
+        
+        Jdot.setZero();
+        
+        jacobian_derivative(t, this->_centerOfMass[t], center_of_mass_velocity(t), Jdot);
+        
+        Eigen::Matrix3d inertiaDerivative = SkewSymmetric(this->_linkTwist[t].tail(3)).as_matrix()*this->_linkInertia[t];
+        
+        // C += m*Jv'*Jvdot + Jw'*(Idot*Jw + I*Jwdot)
+        
+        temp.noalias()  = inertiaDerivative.lazyProduct(J.bottomRows(3));
+        temp.noalias() += this->_linkInertia[t].lazyProduct(Jdot.bottomRows(3));
+        
+        this->_jointCoriolisMatrix.topLeftCorner(k+1,k+1).noalias() += this->_linkMass[t] * J.topRows(3).transpose().lazyProduct(Jdot.topRows(3));
+        this->_jointCoriolisMatrix.topLeftCorner(k+1,k+1).noalias() += J.bottomRows(3).transpose().lazyProduct(temp);
+    }
+    
+    this->_coriolisMatrixIsOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Compute the centripetal and Coriolis torques without forming the matrix             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_joint_coriolis_vector()
+{
+     // C(q,qdot)*qdot is the inverse dynamics with zero joint acceleration and no gravity,
+     // so the recursive Newton-Euler algorithm gives it in O(n) time (Featherstone, 2008, Section 5.3).
+     
+     compute_spatial_state();
+     
+     JointVector &zeroAcceleration = this->_workspace.axisTorque;                                   // Use preallocated memory
+     zeroAcceleration.setZero();
+     
+     recursive_newton_euler(this->_jointVelocity,
+                            zeroAcceleration,
+                            Eigen::Vector<double,6>::Zero(),
+                            this->_workspace,
+                            this->_jointCoriolisVector);
+     
+     this->_coriolisVectorIsOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Compute the joint torques needed to oppose gravity                          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_joint_gravity_vector()
+{
+    // The gravitational force on every link is accumulated from the tips toward the base,
+    // then projected on to each joint axis. This is O(n) rather than summing m*Jv'*g per link.
+    
+    std::vector<Eigen::Vector<double,6>> &force = this->_workspace.force;                           // Gravitational force on each subtree
+    
+    for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+    {
+        force[t].head(3) = -this->_linkMass[t] * this->_gravityVector;                              // Force needed to hold the link up
+        force[t].tail(3) = this->_centerOfMass[t].cross(force[t].head<3>());                        // Moment about the global origin
+    }
+    
+    for(int t = this->_numberOfJoints-1; t >= 0; --t)
+    {
+        unsigned int k = this->_jointNumber[t];
+        
+        if(this->_isRevolute[t])
+        {
+            // Moment about the joint axis
+            this->_jointGravityVector(k) = this->_jointAxis[t].dot(force[t].tail<3>()
+                                         - this->_linkPose[t].translation().cross(force[t].head<3>()));
+        }
+        else this->_jointGravityVector(k) = this->_jointAxis[t].dot(force[t].head<3>());           // Force along the joint axis
+        
+        if(this->_parentIndex[t] >= 0) force[this->_parentIndex[t]] += force[t];
+    }
+    
+    this->_gravityVectorIsOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Compute the inertia and Coriolis coupling between the joints and base            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_joint_base_matrices()
+{
+    this->_jointBaseInertiaMatrix.setZero();
+    this->_jointBaseCoriolisMatrix.setZero();
+    
+    for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+    {
+        unsigned int k = this->_jointNumber[t];
+        
+        auto J = this->_workspace.jacobian.leftCols(k+1);
+        
+        jacobian(t, this->_centerOfMass[t], J);
+        
+        auto Jv = J.topRows(3);
+        auto Jw = J.bottomRows(3);
+        
+        double mass = this->_linkMass[t];
+        
+        // NOTE: -m*(S(r)*Jv)' = m*Jv'*S(r) since S(r) is skew-symmetric
+        
+        this->_jointBaseInertiaMatrix.block(0,0,k+1,3) += mass * Jv.transpose();
+        this->_jointBaseInertiaMatrix.block(0,3,k+1,3).noalias() += Jw.transpose().lazyProduct(this->base.inertia());
+        this->_jointBaseInertiaMatrix.block(0,3,k+1,3).noalias() += mass * Jv.transpose().lazyProduct(SkewSymmetric(this->_centerOfMass[t] - this->base.pose().translation()).as_matrix());
+        
+        this->_jointBaseCoriolisMatrix.block(0,3,k+1,3).noalias() += Jw.transpose().lazyProduct(this->base.inertia_derivative());
+        this->_jointBaseCoriolisMatrix.block(0,3,k+1,3).noalias() += mass * Jv.transpose().lazyProduct(SkewSymmetric(this->_linkTwist[t].head(3)).as_matrix());
+    }
+    
+    this->_jointBaseTermsAreOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Compute the center of mass and centroidal momentum of the whole robot                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_centroidal_terms()
+{
+     // Orin, D. E., Goswami, A., & Lee, S. H. (2013).
+     // "Centroidal dynamics of a humanoid robot."
+     // Autonomous Robots, 35(2), pp. 161-176.
+     //
+     // Column j of the centroidal momentum matrix is the momentum of the subtree of joint j
+     // when it moves at unit speed, i.e. the composite inertia times the spatial joint axis.
+     // The linear part divided by the total mass is the center of mass Jacobian.
+     
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     std::vector<Vector<double,6>>   &motionSubspace   = this->_workspace.motionSubspace;           // Spatial axis of each joint
+     std::vector<Matrix<double,6,6>> &compositeInertia = this->_workspace.inertia;                  // Inertia of each subtree
+     
+     compute_spatial_state();                                                                       // Link inertias and joint axes from the current state
+     
+     this->_totalMass = this->base.mass();
+     
+     this->_centerOfMassPosition = this->base.mass()*this->base.center_of_mass();
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          this->_totalMass += this->_linkMass[t];
+          
+          this->_centerOfMassPosition += this->_linkMass[t]*this->_centerOfMass[t];
+     }
+     
+     if(this->_totalMass > 0.0) this->_centerOfMassPosition /= this->_totalMass;
+     
+     // Accumulate the subtree inertias from the tips toward the base
+     for(int t = this->_numberOfJoints-1; t >= 0; --t)
+     {
+          if(this->_parentIndex[t] >= 0) compositeInertia[this->_parentIndex[t]] += compositeInertia[t];
+     }
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int j = this->_jointNumber[t];
+          
+          Vector<double,6> momentum = compositeInertia[t]*motionSubspace[t];                        // Angular momentum is about the global origin
+          
+          this->_centroidalMomentumMatrix.col(j).head(3) = momentum.head(3);
+          this->_centroidalMomentumMatrix.col(j).tail(3) = momentum.tail<3>() - this->_centerOfMassPosition.cross(momentum.head<3>());
+     }
+     
+     if(this->_totalMass > 0.0) this->_centerOfMassJacobian = this->_centroidalMomentumMatrix.topRows(3)/this->_totalMass;
+     else                       this->_centerOfMassJacobian.setZero();
+     
+     this->_centroidalTermsAreOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute all dynamic properties every time the state is updated               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::use_eager_dynamics()
+{
+    this->_updateMode = eager;
+    
+    std::cout << "[INFO] [KINEMATIC TREE] Computing all dynamics when the state is updated.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute dynamic properties only when they are requested                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::use_lazy_dynamics()
+{
+    this->_updateMode = lazy;
+    
+    std::cout << "[INFO] [KINEMATIC TREE] Computing dynamics only when requested.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Update independent branches of the tree on separate threads                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::use_parallel_kinematics()
+{
+    this->_kinematicsMode = parallel;
+    
+    std::cout << "[INFO] [KINEMATIC TREE] Computing the kinematics of " << this->_branches.size()
+              << " branches in parallel on " << this->_workerPool->number_of_threads() << " threads.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Update the links of the tree one at a time                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::use_serial_kinematics()
+{
+    this->_kinematicsMode = serial;
+    
+    std::cout << "[INFO] [KINEMATIC TREE] Computing the kinematics serially.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Compute the joint inertia matrix with the Composite Rigid Body Algorithm            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_joint_inertia_matrix()
+{
+     // Walker, M. W., & Orin, D. E. (1982).
+     // "Efficient dynamic computer simulation of robotic mechanisms."
+     // Journal of Dynamic Systems, Measurement, and Control, 104(3), pp. 205-211.
+     //
+     // Spatial inertias are expressed in the base frame, so composite inertias
+     // are a simple sum over each subtree (Featherstone, 2008, Section 6.2).
+     
+     compute_spatial_state();
+     
+     composite_rigid_body(this->_workspace, this->_jointInertiaMatrix);
+     
+     this->_inertiaMatrixIsOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //         Assemble the joint inertia matrix from spatial joint axes and link inertias            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::composite_rigid_body(KinematicTreeWorkspace &workspace,
+                                    Eigen::Ref<Eigen::MatrixXd> jointInertiaMatrix) const
+{
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     std::vector<Vector<double,6>>   &motionSubspace   = workspace.motionSubspace;                  // Spatial axis of each joint
+     std::vector<Matrix<double,6,6>> &compositeInertia = workspace.inertia;                         // Inertia of each subtree
+     
+     // Accumulate the subtree inertias from the tips toward the base
+     for(int t = this->_numberOfJoints-1; t >= 0; --t)
+     {
+          if(this->_parentIndex[t] >= 0) compositeInertia[this->_parentIndex[t]] += compositeInertia[t];
+     }
+     
+     jointInertiaMatrix.setZero();
+     
+     // Project the composite inertia on to every joint between this one and the base
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          
+          Vector<double,6> force = compositeInertia[t]*motionSubspace[t];                           // Force needed to accelerate the subtree about this joint
+          
+          jointInertiaMatrix(i,i) = motionSubspace[t].dot(force);
+          
+          for(int s = this->_parentIndex[t]; s >= 0; s = this->_parentIndex[s])
+          {
+               unsigned int j = this->_jointNumber[s];
+               
+               jointInertiaMatrix(i,j) = motionSubspace[s].dot(force);
+               jointInertiaMatrix(j,i) = jointInertiaMatrix(i,j);
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Solve a linear system with the joint inertia matrix                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::joint_inertia_solve(const Eigen::MatrixXd &B)
+{
+     if(B.rows() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] joint_inertia_solve(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the input argument had " + std::to_string(B.rows()) + " rows.");
+     }
+     
+     update_joint_inertia_factor();
+     
+     Eigen::MatrixXd X(B.rows(), B.cols());                                                         // Value to be returned
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t) X.row(t) = B.row(this->_jointNumber[t]); // Put in topological order
+     
+     factored_inertia_solve(this->_jointInertiaFactor, X);
+     
+     Eigen::MatrixXd solution(B.rows(), B.cols());
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t) solution.row(this->_jointNumber[t]) = X.row(t);
+     
+     return solution;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Apply the inverse factor of the joint inertia matrix to a matrix                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::joint_inertia_factor_solve(const Eigen::MatrixXd &B)
+{
+     if(B.rows() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] joint_inertia_factor_solve(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the input argument had " + std::to_string(B.rows()) + " rows.");
+     }
+     
+     update_joint_inertia_factor();
+     
+     Eigen::MatrixXd Y(B.rows(), B.cols());
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t) Y.row(t) = B.row(this->_jointNumber[t]); // Put in topological order
+     
+     factored_inertia_root_solve(this->_jointInertiaFactor, Y);
+     
+     Eigen::MatrixXd solution(B.rows(), B.cols());                                                  // Value to be returned
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t) solution.row(this->_jointNumber[t]) = Y.row(t); // Back to joint order, like joint_inertia_solve()
+     
+     return solution;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Factorise the joint inertia matrix for the current state                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::update_joint_inertia_factor()
+{
+     if(not this->_inertiaFactorIsOutdated) return;
+     
+     factorise_joint_inertia(joint_inertia_matrix(), this->_jointInertiaFactor);
+     
+     this->_inertiaFactorIsOutdated = false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Factorise a joint inertia matrix as L'*D*L along the branches of the tree         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::factorise_joint_inertia(const Eigen::Ref<const Eigen::MatrixXd> &jointInertiaMatrix,
+                                       Eigen::Ref<Eigen::MatrixXd> factor) const
+{
+     // Featherstone, R. (2005).
+     // "Efficient factorization of the joint-space inertia matrix for branched kinematic trees."
+     // The International Journal of Robotics Research, 24(6), pp. 487-500.
+     //
+     // Parents precede their children in the topological order, so the non-zero entries of
+     // row k are k and its ancestors, and eliminating from the tips toward the base causes no fill-in.
+     
+     // Copy the entries between each joint and its ancestors in to topological order
+     for(unsigned int k = 0; k < this->_numberOfJoints; ++k)
+     {
+          for(int i = k; i >= 0; i = this->_parentIndex[i])
+          {
+               factor(k,i) = jointInertiaMatrix(this->_jointNumber[k], this->_jointNumber[i]);
+          }
+     }
+     
+     for(int k = this->_numberOfJoints-1; k >= 0; --k)
+     {
+          for(int i = this->_parentIndex[k]; i >= 0; i = this->_parentIndex[i])
+          {
+               double a = factor(k,i)/factor(k,k);
+               
+               for(int j = i; j >= 0; j = this->_parentIndex[j]) factor(i,j) -= a*factor(k,j);
+               
+               factor(k,i) = a;                                                                     // Element of L
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Solve M*X = B given the L'*D*L factors of the inertia matrix                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::factored_inertia_solve(const Eigen::Ref<const Eigen::MatrixXd> &factor,
+                                      Eigen::Ref<Eigen::MatrixXd> X) const
+{
+     // Solve L'*Z = B from the tips toward the base
+     for(int i = this->_numberOfJoints-1; i >= 0; --i)
+     {
+          for(int j = this->_parentIndex[i]; j >= 0; j = this->_parentIndex[j]) X.row(j) -= factor(i,j)*X.row(i);
+     }
+     
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i) X.row(i) /= factor(i,i);               // Divide by D
+     
+     // Solve L*X = Z from the base toward the tips
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i)
+     {
+          for(int j = this->_parentIndex[i]; j >= 0; j = this->_parentIndex[j]) X.row(i) -= factor(i,j)*X.row(j);
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Apply the inverse of the L'*L factor of the inertia matrix to a matrix            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::factored_inertia_root_solve(const Eigen::Ref<const Eigen::MatrixXd> &factor,
+                                           Eigen::Ref<Eigen::MatrixXd> X) const
+{
+     // M = L'*D*L = (D^1/2*L)'*(D^1/2*L), so we need D^-1/2*L^-T*X
+     
+     for(int i = this->_numberOfJoints-1; i >= 0; --i)
+     {
+          for(int j = this->_parentIndex[i]; j >= 0; j = this->_parentIndex[j]) X.row(j) -= factor(i,j)*X.row(i);
+     }
+     
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i) X.row(i) /= sqrt(factor(i,i));
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Compute joint torques with the recursive Newton-Euler algorithm                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::VectorXd
+KinematicTree::inverse_dynamics(const Eigen::VectorXd &jointPosition,
+                                const Eigen::VectorXd &jointVelocity,
+                                const Eigen::VectorXd &jointAcceleration)
+{
+     // Luh, J. Y. S., Walker, M. W., & Paul, R. P. C. (1980).
+     // "On-line computational scheme for mechanical manipulators."
+     // Journal of Dynamic Systems, Measurement, and Control, 102(2), pp. 69-76.
+     //
+     // All spatial quantities are expressed in the base frame, so no coordinate
+     // transforms are needed between links (Featherstone, 2008, Section 5.3).
+     
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     if(jointAcceleration.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] inverse_dynamics(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the acceleration argument had " + std::to_string(jointAcceleration.size()) + " elements.");
+     }
+     
+     VectorXd jointTorque(this->_numberOfJoints);                                                   // Value to be returned
+     
+     compute_spatial_kinematics(jointPosition, jointVelocity, this->base.pose(), this->base.twist(), this->_workspace);
+     
+     recursive_newton_euler(jointVelocity, jointAcceleration, base_acceleration(), this->_workspace, jointTorque);
+     
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i)
+     {
+          jointTorque(i) += this->_joint[i].damping()*jointVelocity(i);                             // Add viscous friction
+     }
+     
+     return jointTorque;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Compute the joint torques needed to oppose gravity at a given configuration         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::VectorXd
+KinematicTree::gravity_torques(const Eigen::VectorXd &jointPosition,
+                               const Eigen::Vector3d &gravity) const
+{
+     std::vector<Pose>                    pose(this->_numberOfJoints);                              // Local memory, so the model is not altered
+     std::vector<Eigen::Vector<double,6>> axis(this->_numberOfJoints);
+     std::vector<Eigen::Vector<double,6>> force(this->_numberOfJoints);
+     
+     Eigen::VectorXd jointTorque(this->_numberOfJoints);                                            // Value to be returned
+     
+     compute_gravity_torques(jointPosition, gravity, this->base.pose(), pose, axis, force, jointTorque);
+     
+     return jointTorque;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Compute the joint torques needed to oppose gravity for one thread                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::VectorXd
+KinematicTree::gravity_torques(const Eigen::VectorXd &jointPosition,
+                               KinematicTreeData     &data) const
+{
+     if(data.workspace.pose.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] gravity_torques(): "
+                                      "The data was not made for this model. Use make_data() to create it.");
+     }
+     
+     Eigen::VectorXd jointTorque(this->_numberOfJoints);                                            // Value to be returned
+     
+     compute_gravity_torques(jointPosition, data.gravity, data.basePose,
+                             data.workspace.pose, data.workspace.motionSubspace, data.workspace.force, jointTorque);
+     
+     return jointTorque;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Propagate the weight of each subtree and project it on to the joints            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_gravity_torques(const Eigen::VectorXd &jointPosition,
+                                       const Eigen::Vector3d &gravity,
+                                       const Pose &basePose,
+                                       std::vector<Pose> &pose,
+                                       std::vector<Eigen::Vector<double,6>> &axis,
+                                       std::vector<Eigen::Vector<double,6>> &force,
+                                       Eigen::VectorXd &jointTorque) const
+{
+     // With zero joint velocity and acceleration, the recursive Newton-Euler algorithm reduces to
+     // propagating the weight of each subtree toward the base, so no inertia or velocity terms are needed.
+     
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     if(jointPosition.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] gravity_torques(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the position argument had " + std::to_string(jointPosition.size()) + " elements.");
+     }
+     
+     // Forward pass: find the joint axes and the weight of each link about the global origin
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          pose[t] = ((p < 0) ? basePose : pose[p])*this->_jointOrigin[t];
+          
+          Vector3d jointAxis = (pose[t].rotation()*this->_localJointAxis[t]).normalized();          // Axis of actuation in base frame
+          
+          pose[t] *= this->_joint[i].position_offset(jointPosition(i));                             // NOTE: This can throw an error!
+          
+          if(this->_isRevolute[t])
+          {
+               axis[t].head(3) = pose[t].translation().cross(jointAxis);
+               axis[t].tail(3) = jointAxis;
+          }
+          else
+          {
+               axis[t].head(3) = jointAxis;
+               axis[t].tail(3).setZero();
+          }
+          
+          force[t].head(3) = -this->_linkMass[t]*gravity;                                           // Force needed to hold the link up
+          force[t].tail(3) = (pose[t]*this->_localCenterOfMass[t]).cross(force[t].head<3>());       // Moment about the global origin
+     }
+     
+     // Backward pass: project the weight of each subtree on to its joint axis
+     for(int t = this->_numberOfJoints-1; t >= 0; --t)
+     {
+          jointTorque(this->_jointNumber[t]) = axis[t].dot(force[t]);
+          
+          if(this->_parentIndex[t] >= 0) force[this->_parentIndex[t]] += force[t];
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Compute joint torques from spatial joint axes, link velocities, and inertias          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::recursive_newton_euler(const Eigen::Ref<const Eigen::VectorXd> &jointVelocity,
+                                      const Eigen::Ref<const Eigen::VectorXd> &jointAcceleration,
+                                      const Eigen::Vector<double,6> &baseAcceleration,
+                                      KinematicTreeWorkspace &workspace,
+                                      Eigen::Ref<Eigen::VectorXd> jointTorque) const
+{
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     // Variables used in this scope
+     std::vector<Vector<double,6>>   &motionSubspace = workspace.motionSubspace;                    // Spatial axis of each joint
+     std::vector<Vector<double,6>>   &velocity       = workspace.velocity;                          // Spatial velocity of each link
+     std::vector<Matrix<double,6,6>> &inertia        = workspace.inertia;                           // Spatial inertia of each link
+     std::vector<Vector<double,6>>   &acceleration   = workspace.acceleration;                      // Spatial acceleration of each link
+     std::vector<Vector<double,6>>   &force          = workspace.force;                             // Spatial force transmitted through each joint
+     
+     // Forward pass: propagate accelerations from base to tips
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          acceleration[t] = (p < 0) ? baseAcceleration : acceleration[p];
+          
+          acceleration[t] += motionSubspace[t]*jointAcceleration(i)
+                           + cross_motion(velocity[t], motionSubspace[t]*jointVelocity(i));
+          
+          force[t] = inertia[t]*acceleration[t] + cross_force(velocity[t], inertia[t]*velocity[t]);  // Newton-Euler equation
+     }
+     
+     // Backward pass: project forces on to the joint axes and accumulate toward the base
+     for(int t = this->_numberOfJoints-1; t >= 0; --t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          
+          jointTorque(i) = motionSubspace[t].dot(force[t]);
+          
+          if(this->_parentIndex[t] >= 0) force[this->_parentIndex[t]] += force[t];
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Compute the partial derivatives of the inverse dynamics                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::inverse_dynamics_derivatives(const Eigen::VectorXd &jointPosition,
+                                            const Eigen::VectorXd &jointVelocity,
+                                            const Eigen::VectorXd &jointAcceleration,
+                                            Eigen::MatrixXd &torqueByPosition,
+                                            Eigen::MatrixXd &torqueByVelocity)
+{
+     if(jointAcceleration.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] inverse_dynamics_derivatives(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the acceleration argument had " + std::to_string(jointAcceleration.size()) + " elements.");
+     }
+     
+     torqueByPosition.resize(this->_numberOfJoints, this->_numberOfJoints);
+     torqueByVelocity.resize(this->_numberOfJoints, this->_numberOfJoints);
+     
+     compute_spatial_kinematics(jointPosition, jointVelocity, this->base.pose(), this->base.twist(), this->_workspace);
+     
+     recursive_newton_euler(jointVelocity, jointAcceleration, base_acceleration(), this->_workspace, this->_workspace.axisTorque);
+     
+     recursive_newton_euler_derivatives(this->_workspace, torqueByPosition, torqueByVelocity);
+     
+     for(unsigned int i = 0; i < this->_numberOfJoints; ++i)
+     {
+          torqueByVelocity(i,i) += this->_joint[i].damping();                                       // Add viscous friction
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Differentiate the recursive Newton-Euler algorithm with respect to the state         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::recursive_newton_euler_derivatives(KinematicTreeWorkspace &workspace,
+                                                  Eigen::Ref<Eigen::MatrixXd> torqueByPosition,
+                                                  Eigen::Ref<Eigen::MatrixXd> torqueByVelocity) const
+{
+     // Carpentier, J., & Mansard, N. (2018).
+     // "Analytical derivatives of rigid body dynamics algorithms."
+     // Robotics: Science and Systems XIV.
+     //
+     // In the base frame, moving joint j displaces its whole subtree by the spatial motion S_j.
+     // For every link k in the subtree of j, with p the parent of j:
+     //
+     //      dS_k/dq_j = S_j x S_k
+     //      dI_k/dq_j = S_j x* I_k - I_k S_j x
+     //      dv_k/dq_j = S_j x (v_k - v_p)
+     //      da_k/dq_j = S_j x (a_k - a_p) - (S_j x v_p) x (v_k - v_p)
+     //
+     //      dv_k/dqdot_j = S_j
+     //      da_k/dqdot_j = S_j x (v_k - v_p) + v_j x S_j
+     //
+     // and these are zero for links outside the subtree. The derivative of each link force is then
+     // accumulated toward the base as in the backward pass, giving one O(n) sweep for each joint.
+     
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     // Variables used in this scope
+     std::vector<Vector<double,6>>   &motionSubspace = workspace.motionSubspace;                    // Spatial axis of each joint
+     std::vector<Vector<double,6>>   &velocity       = workspace.velocity;                          // Spatial velocity of each link
+     std::vector<Vector<double,6>>   &acceleration   = workspace.acceleration;                      // Spatial acceleration of each link
+     std::vector<Matrix<double,6,6>> &inertia        = workspace.inertia;                           // Spatial inertia of each link
+     std::vector<Vector<double,6>>   &force          = workspace.force;                             // Spatial force transmitted through each joint
+     std::vector<Vector<double,6>>   &dv             = workspace.velocityDerivative;                // Derivative of each link velocity
+     std::vector<Vector<double,6>>   &da             = workspace.accelerationDerivative;            // Derivative of each link acceleration
+     std::vector<Vector<double,6>>   &df             = workspace.forceDerivative;                   // Derivative of the force on each subtree
+     
+     // Velocity of the base referenced to the global origin
+     Vector<double,6> baseVelocity = this->base.twist();
+     baseVelocity.head(3) += this->base.pose().translation().cross(baseVelocity.tail<3>());
+     
+     Vector<double,6> baseAcceleration = base_acceleration();
+     
+     std::vector<bool> inSubtree(this->_numberOfJoints);                                            // Links moved by the current joint
+     
+     for(unsigned int s = 0; s < this->_numberOfJoints; ++s)
+     {
+          unsigned int j = this->_jointNumber[s];
+          int          p = this->_parentIndex[s];
+          
+          const Vector<double,6> &axis               = motionSubspace[s];
+          const Vector<double,6> &parentVelocity     = (p < 0) ? baseVelocity     : velocity[p];
+          const Vector<double,6> &parentAcceleration = (p < 0) ? baseAcceleration : acceleration[p];
+          
+          Vector<double,6> axisCrossParentVelocity = cross_motion(axis, parentVelocity);
+          
+          // Links before this one in the topological order cannot be in its subtree
+          for(unsigned int t = 0; t < s; ++t)
+          {
+               inSubtree[t] = false;
+               df[t].setZero();
+          }
+          
+          // Derivatives with respect to the joint position
+          for(unsigned int t = s; t < this->_numberOfJoints; ++t)
+          {
+               inSubtree[t] = (t == s) or (this->_parentIndex[t] >= 0 and inSubtree[this->_parentIndex[t]]);
+               
+               if(not inSubtree[t])
+               {
+                    df[t].setZero();
+                    continue;
+               }
+               
+               Vector<double,6> relativeVelocity = velocity[t] - parentVelocity;
+               
+               dv[t] = cross_motion(axis, relativeVelocity);
+               da[t] = cross_motion(axis, acceleration[t] - parentAcceleration)
+                     - cross_motion(axisCrossParentVelocity, relativeVelocity);
+               
+               Vector<double,6> momentum = inertia[t]*velocity[t];
+               
+               // d(I*a + v x* I*v) = dI*a + I*da + dv x* I*v + v x* (dI*v + I*dv)
+               df[t] = cross_force(axis, inertia[t]*acceleration[t]) - inertia[t]*cross_motion(axis, acceleration[t])
+                     + inertia[t]*da[t]
+                     + cross_force(dv[t], momentum)
+                     + cross_force(velocity[t], cross_force(axis, momentum) - inertia[t]*cross_motion(axis, velocity[t]) + inertia[t]*dv[t]);
+          }
+          
+          for(int t = this->_numberOfJoints-1; t >= 0; --t)
+          {
+               unsigned int i = this->_jointNumber[t];
+               
+               torqueByPosition(i,j) = motionSubspace[t].dot(df[t]);
+               
+               if(inSubtree[t]) torqueByPosition(i,j) += cross_motion(axis, motionSubspace[t]).dot(force[t]); // The joint axis moves too
+               
+               if(this->_parentIndex[t] >= 0) df[this->_parentIndex[t]] += df[t];
+          }
+          
+          // Derivatives with respect to the joint velocity
+          Vector<double,6> axisRate = cross_motion(velocity[s], axis);                              // Time derivative of this joint axis
+          
+          for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+          {
+               if(not inSubtree[t])
+               {
+                    df[t].setZero();
+                    continue;
+               }
+               
+               da[t] = cross_motion(axis, velocity[t] - parentVelocity) + axisRate;
+               
+               df[t] = inertia[t]*da[t]
+                     + cross_force(axis, inertia[t]*velocity[t])
+                     + cross_force(velocity[t], inertia[t]*axis);
+          }
+          
+          for(int t = this->_numberOfJoints-1; t >= 0; --t)
+          {
+               torqueByVelocity(this->_jointNumber[t], j) = motionSubspace[t].dot(df[t]);
+               
+               if(this->_parentIndex[t] >= 0) df[this->_parentIndex[t]] += df[t];
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Compute joint accelerations with the Articulated Body Algorithm                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::VectorXd
+KinematicTree::forward_dynamics(const Eigen::VectorXd &jointPosition,
+                                const Eigen::VectorXd &jointVelocity,
+                                const Eigen::VectorXd &jointTorque)
+{
+     // Featherstone, R. (1983).
+     // "The calculation of robot dynamics using articulated-body inertias."
+     // The International Journal of Robotics Research, 2(1), pp. 13-30.
+     //
+     // Implemented in base coordinates as per Featherstone (2008), Section 7.3.
+     
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     if(jointTorque.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] forward_dynamics(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the torque argument had " + std::to_string(jointTorque.size()) + " elements.");
+     }
+     
+     // Variables used in this scope
+     std::vector<Vector<double,6>>   &motionSubspace = this->_workspace.motionSubspace;             // Spatial axis of each joint
+     std::vector<Vector<double,6>>   &velocity       = this->_workspace.velocity;                   // Spatial velocity of each link
+     std::vector<Matrix<double,6,6>> &inertia        = this->_workspace.inertia;                    // Articulated inertia of each link
+     std::vector<Vector<double,6>>   &bias           = this->_workspace.bias;                       // Velocity-product acceleration of each joint
+     std::vector<Vector<double,6>>   &biasForce      = this->_workspace.force;                      // Articulated bias force of each link
+     std::vector<Vector<double,6>>   &U              = this->_workspace.inertiaAxis;                // Articulated inertia times joint axis
+     std::vector<Vector<double,6>>   &acceleration   = this->_workspace.acceleration;               // Spatial acceleration of each link
+     JointVector &D = this->_workspace.axisInertia;                                                 // Inertia about each joint axis
+     JointVector &u = this->_workspace.axisTorque;                                                  // Torque available to accelerate each joint
+     VectorXd jointAcceleration(this->_numberOfJoints);                                             // Value to be returned
+     
+     compute_spatial_kinematics(jointPosition, jointVelocity, this->base.pose(), this->base.twist(), this->_workspace);
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          bias[t] = cross_motion(velocity[t], motionSubspace[t]*jointVelocity(this->_jointNumber[t]));
+          
+          biasForce[t] = cross_force(velocity[t], inertia[t]*velocity[t]);
+     }
+     
+     // Backward pass: compute articulated-body inertias from tips to base
+     for(int t = this->_numberOfJoints-1; t >= 0; --t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          U[t] = inertia[t]*motionSubspace[t];
+          D(t) = motionSubspace[t].dot(U[t]);
+          u(t) = jointTorque(i)
+               - this->_joint[i].damping()*jointVelocity(i)
+               - motionSubspace[t].dot(biasForce[t]);
+          
+          if(D(t) <= 0.0)
+          {
+               throw std::runtime_error("[ERROR] [KINEMATIC TREE] forward_dynamics(): "
+                                        "The '" + this->_link[i]->name() + "' link and its children have no inertia "
+                                        "about the " + this->_joint[i].name() + " joint axis.");
+          }
+          
+          if(p >= 0)
+          {
+               Matrix<double,6,6> articulatedInertia = inertia[t] - U[t]*U[t].transpose()/D(t);
+               
+               inertia[p]   += articulatedInertia;
+               biasForce[p] += biasForce[t] + articulatedInertia*bias[t] + U[t]*u(t)/D(t);
+          }
+     }
+     
+     // Forward pass: resolve the joint accelerations from base to tips
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          acceleration[t] = (p < 0) ? base_acceleration() : acceleration[p];
+          
+          acceleration[t] += bias[t];
+          
+          jointAcceleration(i) = (u(t) - U[t].dot(acceleration[t]))/D(t);
+          
+          acceleration[t] += motionSubspace[t]*jointAcceleration(i);
+     }
+     
+     return jointAcceleration;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Compute the partial derivatives of the forward dynamics                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::forward_dynamics_derivatives(const Eigen::VectorXd &jointPosition,
+                                            const Eigen::VectorXd &jointVelocity,
+                                            const Eigen::VectorXd &jointTorque,
+                                            Eigen::MatrixXd &accelerationByPosition,
+                                            Eigen::MatrixXd &accelerationByVelocity,
+                                            Eigen::MatrixXd &accelerationByTorque)
+{
+     Eigen::VectorXd jointAcceleration = forward_dynamics(jointPosition, jointVelocity, jointTorque);
+     
+     inverse_dynamics_derivatives(jointPosition, jointVelocity, jointAcceleration, accelerationByPosition, accelerationByVelocity);
+     
+     // The spatial kinematics are still in the workspace, but the link inertias are overwritten here
+     Eigen::MatrixXd jointInertiaMatrix(this->_numberOfJoints, this->_numberOfJoints);
+     
+     composite_rigid_body(this->_workspace, jointInertiaMatrix);
+     
+     Eigen::MatrixXd factor(this->_numberOfJoints, this->_numberOfJoints);
+     
+     factorise_joint_inertia(jointInertiaMatrix, factor);
+     
+     // Solve in topological order, then put the rows and columns back in the order of the joint numbers
+     Eigen::MatrixXd inverse = Eigen::MatrixXd::Identity(this->_numberOfJoints, this->_numberOfJoints);
+     
+     factored_inertia_solve(factor, inverse);
+     
+     accelerationByTorque.resize(this->_numberOfJoints, this->_numberOfJoints);
+     
+     for(unsigned int s = 0; s < this->_numberOfJoints; ++s)
+     {
+          for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+          {
+               accelerationByTorque(this->_jointNumber[s], this->_jointNumber[t]) = inverse(s,t);
+          }
+     }
+     
+     accelerationByPosition = -accelerationByTorque*accelerationByPosition;
+     accelerationByVelocity = -accelerationByTorque*accelerationByVelocity;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Compute spatial axes, velocities, and inertias from the current state               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_spatial_state()
+{
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     std::vector<Vector<double,6>>   &motionSubspace = this->_workspace.motionSubspace;             // Spatial axis of each joint
+     std::vector<Vector<double,6>>   &velocity       = this->_workspace.velocity;                   // Spatial velocity of each link
+     std::vector<Matrix<double,6,6>> &inertia        = this->_workspace.inertia;                    // Spatial inertia of each link
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          const Vector3d &position = this->_linkPose[t].translation();
+          
+          if(this->_isRevolute[t])
+          {
+               motionSubspace[t].head(3) = position.cross(this->_jointAxis[t]);
+               motionSubspace[t].tail(3) = this->_jointAxis[t];
+          }
+          else
+          {
+               motionSubspace[t].head(3) = this->_jointAxis[t];
+               motionSubspace[t].tail(3).setZero();
+          }
+          
+          velocity[t] = this->_linkTwist[t];
+          velocity[t].head(3) += position.cross(this->_linkTwist[t].tail<3>());                    // Referenced to the global origin
+          
+          inertia[t] = spatial_inertia(this->_linkMass[t], this->_linkInertia[t], this->_centerOfMass[t]);
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Compute spatial axes, velocities, and inertias for a given joint state              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_spatial_kinematics(const Eigen::Ref<const Eigen::VectorXd> &jointPosition,
+                                          const Eigen::Ref<const Eigen::VectorXd> &jointVelocity,
+                                          const Pose                              &basePose,
+                                          const Eigen::Vector<double,6>           &baseTwist,
+                                          KinematicTreeWorkspace                  &workspace) const
+{
+     using namespace Eigen;                                                                         // Eigen::Vector, Eigen::Matrix
+     
+     if(jointPosition.size() != this->_numberOfJoints or jointVelocity.size() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] compute_spatial_kinematics(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the position argument had " + std::to_string(jointPosition.size()) + " elements, and "
+                                      "the velocity argument had " + std::to_string(jointVelocity.size()) + " elements.");
+     }
+     
+     std::vector<Pose>               &pose           = workspace.pose;                              // Pose of each link
+     std::vector<Vector<double,6>>   &motionSubspace = workspace.motionSubspace;                    // Spatial axis of each joint
+     std::vector<Vector<double,6>>   &velocity       = workspace.velocity;                          // Spatial velocity of each link
+     
+     // Velocity of the base referenced to the global origin
+     Vector<double,6> baseVelocity = baseTwist;
+     baseVelocity.head(3) += basePose.translation().cross(baseVelocity.tail<3>());
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          pose[t] = ((p < 0) ? basePose : pose[p])*this->_jointOrigin[t];
+          
+          Vector3d axis = (pose[t].rotation()*this->_localJointAxis[t]).normalized();               // Axis of actuation in base frame
+          
+          pose[t] *= this->_joint[i].position_offset(jointPosition(i));                             // NOTE: This can throw an error!
+          
+          if(this->_isRevolute[t])
+          {
+               motionSubspace[t].head(3) = pose[t].translation().cross(axis);
+               motionSubspace[t].tail(3) = axis;
+          }
+          else
+          {
+               motionSubspace[t].head(3) = axis;
+               motionSubspace[t].tail(3).setZero();
+          }
+          
+          velocity[t] = ((p < 0) ? baseVelocity : velocity[p]) + motionSubspace[t]*jointVelocity(i);
+     }
+     
+     compute_spatial_inertia(workspace);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Compute the spatial inertia of each link from its pose                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compute_spatial_inertia(KinematicTreeWorkspace &workspace) const
+{
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+     {
+          const Pose &pose = workspace.pose[t];
+          
+          Eigen::Matrix3d R = pose.rotation();
+          
+          workspace.inertia[t] = spatial_inertia(this->_linkMass[t],
+                                                 R*this->_localInertia[t]*R.transpose(),
+                                                 pose*this->_localCenterOfMass[t]);
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Set how many threads are used to evaluate batches of configurations            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+KinematicTree::set_number_of_threads(const unsigned int &numberOfThreads)
+{
+     if(numberOfThreads == 0)
+     {
+          std::cerr << "[ERROR] [KINEMATIC TREE] set_number_of_threads(): "
+                    << "Number of threads must be greater than zero." << std::endl;
+          
+          return false;
+     }
+     
+     this->_numberOfThreads = numberOfThreads;
+     
+     // A batch running on another thread holds its own copy of the old pool,
+     // so the old threads are joined when the last user releases them
+     std::atomic_store(&this->_workerPool, std::make_shared<WorkerPool>(numberOfThreads));
+     
+     return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Compute the pose of a frame for many joint configurations                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<Pose>
+KinematicTree::batch_frame_pose(ReferenceFrame *frame,
+                                const Eigen::MatrixXd &jointPositions) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] batch_frame_pose(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     
+     check_batch_dimensions("batch_frame_pose", jointPositions);
+     
+     std::vector<Pose> framePose(jointPositions.cols(), this->base.pose()*frame->relativePose);     // Value to be returned
+     
+     if(frame->link == nullptr) return framePose;                                                   // Frame is on the base, so nothing moves it
+     
+     unsigned int t = this->_topologicalIndex[frame->link->number()];
+     
+     std::vector<unsigned int> links;                                                               // Only the links between the base and the frame
+     for(const unsigned int &j : frame->supportingJoints) links.push_back(this->_topologicalIndex[j]);
+     
+     unsigned int numberOfBlocks = (jointPositions.cols() + BatchLanes - 1)/BatchLanes;
+     
+     run_batch(numberOfBlocks, [&](const unsigned int &block)
+     {
+          thread_local std::vector<Eigen::Array<double,BatchLanes,12>> linkPose;                    // Only allocated on the first call on each thread
+          
+          linkPose.resize(this->_numberOfJoints);
+          
+          forward_kinematics_lanes<BatchLanes>(jointPositions, block*BatchLanes, links, linkPose);
+          
+          for(unsigned int k = 0; k < BatchLanes and block*BatchLanes + k < jointPositions.cols(); ++k)
+          {
+               Eigen::Matrix3d rotation;
+               for(unsigned int c = 0; c < 9; ++c) rotation(c%3,c/3) = linkPose[t](k,c);
+               
+               framePose[block*BatchLanes + k] = Pose(linkPose[t].block<1,3>(k,9).transpose(), Eigen::Quaterniond(rotation))*frame->relativePose;
+          }
+     });
+     
+     return framePose;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute the Jacobian of a frame for many joint configurations                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::batch_jacobian(ReferenceFrame *frame,
+                              const Eigen::MatrixXd &jointPositions) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] batch_jacobian(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     
+     check_batch_dimensions("batch_jacobian", jointPositions);
+     
+     Eigen::MatrixXd jacobianMatrix = Eigen::MatrixXd::Zero(6*jointPositions.cols(), this->_numberOfJoints); // Value to be returned
+     
+     if(frame->link == nullptr) return jacobianMatrix;                                              // Frame is on the base, so nothing moves it
+     
+     unsigned int t = this->_topologicalIndex[frame->link->number()];
+     
+     Eigen::VectorXd jointVelocity = Eigen::VectorXd::Zero(this->_numberOfJoints);                  // Not needed for kinematics
+     
+     run_batch(jointPositions.cols(), [&](KinematicTreeWorkspace &workspace, const unsigned int &i)
+     {
+          compute_spatial_kinematics(jointPositions.col(i), jointVelocity, this->base.pose(), this->base.twist(), workspace);
+          
+          Eigen::Vector3d point = (workspace.pose[t]*frame->relativePose).translation();
+          
+          for(const unsigned int &j : frame->supportingJoints)
+          {
+               const Eigen::Vector<double,6> &axis = workspace.motionSubspace[this->_topologicalIndex[j]];
+               
+               // Shift the spatial joint axis from the global origin to the point
+               jacobianMatrix.block(6*i,j,3,1) = axis.head<3>() + axis.tail<3>().cross(point);
+               jacobianMatrix.block(6*i+3,j,3,1) = axis.tail<3>();
+          }
+     });
+     
+     return jacobianMatrix;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute the joint inertia matrix for many joint configurations               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::batch_joint_inertia_matrix(const Eigen::MatrixXd &jointPositions) const
+{
+     check_batch_dimensions("batch_joint_inertia_matrix", jointPositions);
+     
+     unsigned int n = this->_numberOfJoints;
+     
+     Eigen::MatrixXd inertiaMatrix(n*jointPositions.cols(), n);                                     // Value to be returned
+     
+     Eigen::VectorXd jointVelocity = Eigen::VectorXd::Zero(n);                                      // Not needed for the inertia
+     
+     run_batch(jointPositions.cols(), [&](KinematicTreeWorkspace &workspace, const unsigned int &i)
+     {
+          compute_spatial_kinematics(jointPositions.col(i), jointVelocity, this->base.pose(), this->base.twist(), workspace);
+          
+          composite_rigid_body(workspace, inertiaMatrix.block(n*i,0,n,n));
+     });
+     
+     return inertiaMatrix;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Compute the joint torques for many joint configurations                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::batch_inverse_dynamics(const Eigen::MatrixXd &jointPositions,
+                                      const Eigen::MatrixXd &jointVelocities,
+                                      const Eigen::MatrixXd &jointAccelerations) const
+{
+     check_batch_dimensions("batch_inverse_dynamics", jointPositions);
+     check_batch_dimensions("batch_inverse_dynamics", jointVelocities);
+     check_batch_dimensions("batch_inverse_dynamics", jointAccelerations);
+     
+     if(jointVelocities.cols() != jointPositions.cols() or jointAccelerations.cols() != jointPositions.cols())
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] batch_inverse_dynamics(): "
+                                      "Dimensions of arguments do not match. "
+                                      "The position argument had " + std::to_string(jointPositions.cols()) + " columns, "
+                                      "the velocity argument had " + std::to_string(jointVelocities.cols()) + " columns, and "
+                                      "the acceleration argument had " + std::to_string(jointAccelerations.cols()) + " columns.");
+     }
+     
+     Eigen::MatrixXd jointTorques(this->_numberOfJoints, jointPositions.cols());                    // Value to be returned
+     
+     run_batch(jointPositions.cols(), [&](KinematicTreeWorkspace &workspace, const unsigned int &i)
+     {
+          compute_spatial_kinematics(jointPositions.col(i), jointVelocities.col(i), this->base.pose(), this->base.twist(), workspace);
+          
+          recursive_newton_euler(jointVelocities.col(i), jointAccelerations.col(i), base_acceleration(), workspace, jointTorques.col(i));
+          
+          for(unsigned int j = 0; j < this->_numberOfJoints; ++j)
+          {
+               jointTorques(j,i) += this->_joint[j].damping()*jointVelocities(j,i);                 // Add viscous friction
+          }
+     });
+     
+     return jointTorques;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Compute the positions and rotations of every link for many configurations        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::batch_forward_kinematics(const Eigen::MatrixXd &jointPositions,
+                                        Eigen::MatrixXd &linkPositions,
+                                        Eigen::MatrixXd &linkRotations) const
+{
+     check_batch_dimensions("batch_forward_kinematics", jointPositions);
+     
+     unsigned int n = this->_numberOfJoints;
+     
+     linkPositions.resize(3*n, jointPositions.cols());
+     linkRotations.resize(9*n, jointPositions.cols());
+     
+     std::vector<unsigned int> links(n);
+     for(unsigned int t = 0; t < n; ++t) links[t] = t;
+     
+     unsigned int numberOfBlocks = (jointPositions.cols() + BatchLanes - 1)/BatchLanes;
+     
+     run_batch(numberOfBlocks, [&](const unsigned int &block)
+     {
+          thread_local std::vector<Eigen::Array<double,BatchLanes,12>> linkPose;                    // Only allocated on the first call on each thread
+          
+          linkPose.resize(n);
+          
+          forward_kinematics_lanes<BatchLanes>(jointPositions, block*BatchLanes, links, linkPose);
+          
+          for(unsigned int k = 0; k < BatchLanes and block*BatchLanes + k < jointPositions.cols(); ++k)
+          {
+               unsigned int column = block*BatchLanes + k;
+               
+               for(unsigned int t = 0; t < n; ++t)
+               {
+                    unsigned int i = this->_jointNumber[t];
+                    
+                    linkPositions.block<3,1>(3*i,column) = linkPose[t].block<1,3>(k,9).transpose();
+                    linkRotations.block<9,1>(9*i,column) = linkPose[t].block<1,9>(k,0).transpose();
+               }
+          }
+     });
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Compute the link poses for a block of configurations, one in each SIMD lane        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <int Lanes>
+void
+KinematicTree::forward_kinematics_lanes(const Eigen::MatrixXd &jointPositions,
+                                        const unsigned int &firstColumn,
+                                        const std::vector<unsigned int> &links,
+                                        std::vector<Eigen::Array<double,Lanes,12>> &linkPose) const
+{
+     // Each column of a link pose holds one element of the rotation matrix (or position) for every configuration,
+     // so the arithmetic is the same as for a single configuration, but Lanes at a time.
+     
+     using Lane = Eigen::Array<double,Lanes,1>;
+     
+     Eigen::Array<double,Lanes,12> basePose;
+     {
+          Pose pose = this->base.pose();
+          Eigen::Matrix3d rotation = pose.rotation();
+          for(unsigned int c = 0; c < 9; ++c) basePose.col(c).setConstant(rotation(c%3,c/3));
+          for(unsigned int r = 0; r < 3; ++r) basePose.col(9+r).setConstant(pose.translation()(r));
+     }
+     
+     unsigned int lastColumn = jointPositions.cols() - 1;
+     
+     for(const unsigned int &t : links)
+     {
+          unsigned int i = this->_jointNumber[t];
+          int          p = this->_parentIndex[t];
+          
+          Lane position;
+          for(unsigned int k = 0; k < Lanes; ++k) position(k) = jointPositions(i, std::min(firstColumn + k, lastColumn));
+          
+          Limits limits = this->_joint[i].position_limits();
+          
+          if((position > limits.upper).any() or (position < limits.lower).any())
+          {
+               for(unsigned int k = 0; k < Lanes; ++k) this->_joint[i].position_offset(position(k));     // Throws the error
+          }
+          
+          // Rotation and translation of this link relative to its parent, for every lane
+          const Eigen::Matrix3d &A = this->_originRotation[t];
+          Eigen::Vector3d translation = this->_jointOrigin[t].translation();
+          
+          Lane rotation[9], offset[3];
+          
+          if(this->_isRevolute[t])
+          {
+               const Eigen::Matrix3d &B = this->_originRotationAxis[t];
+               const Eigen::Matrix3d &C = this->_originRotationAxisSquared[t];
+               
+               Lane sine = position.sin();
+               Lane versine = 1.0 - position.cos();
+               
+               for(unsigned int c = 0; c < 9; ++c) rotation[c] = A(c%3,c/3) + sine*B(c%3,c/3) + versine*C(c%3,c/3);
+               for(unsigned int r = 0; r < 3; ++r) offset[r].setConstant(translation(r));
+          }
+          else
+          {
+               Eigen::Vector3d axis = A*this->_localJointAxis[t];                                   // Direction of translation in the parent frame
+               
+               for(unsigned int c = 0; c < 9; ++c) rotation[c].setConstant(A(c%3,c/3));
+               for(unsigned int r = 0; r < 3; ++r) offset[r] = translation(r) + position*axis(r);
+          }
+          
+          // Compose with the parent: R = R_parent*R_joint, p = p_parent + R_parent*p_joint
+          const Eigen::Array<double,Lanes,12> &parent = (p < 0) ? basePose : linkPose[p];
+          Eigen::Array<double,Lanes,12> &pose = linkPose[t];
+          
+          for(unsigned int r = 0; r < 3; ++r)
+          {
+               for(unsigned int c = 0; c < 3; ++c)
+               {
+                    pose.col(3*c+r) = parent.col(r)*rotation[3*c] + parent.col(3+r)*rotation[3*c+1] + parent.col(6+r)*rotation[3*c+2];
+               }
+               
+               pose.col(9+r) = parent.col(9+r) + parent.col(r)*offset[0] + parent.col(3+r)*offset[1] + parent.col(6+r)*offset[2];
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Split a batch of configurations across a number of threads                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::split_batch(const unsigned int &numberOfConfigurations,
+                           const std::function<void(const unsigned int&, const unsigned int&)> &range) const
+{
+     std::shared_ptr<WorkerPool> workerPool = std::atomic_load(&this->_workerPool);                 // Held until the batch is done, even if set_number_of_threads() is called
+     
+     unsigned int numberOfThreads = std::min(workerPool->number_of_threads(), numberOfConfigurations);
+     
+     // Errors are rethrown on this thread by the pool
+     workerPool->run(numberOfThreads, [&](const unsigned int &k)
+     {
+          // Each thread evaluates a contiguous block of configurations
+          unsigned int first = ((unsigned long)k*numberOfConfigurations)/numberOfThreads;
+          unsigned int last  = ((unsigned long)(k+1)*numberOfConfigurations)/numberOfThreads;
+          
+          range(first, last);
+     });
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Evaluate a batch of configurations that need no workspace                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::run_batch(const unsigned int &numberOfConfigurations,
+                         const std::function<void(const unsigned int&)> &task) const
+{
+     split_batch(numberOfConfigurations, [&](const unsigned int &first, const unsigned int &last)
+     {
+          for(unsigned int i = first; i < last; ++i) task(i);
+     });
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Evaluate a batch of configurations, with a workspace for each thread             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::run_batch(const unsigned int &numberOfConfigurations,
+                         const std::function<void(KinematicTreeWorkspace&, const unsigned int&)> &task) const
+{
+     split_batch(numberOfConfigurations, [&](const unsigned int &first, const unsigned int &last)
+     {
+          KinematicTreeWorkspace workspace;                                                         // Every thread needs its own memory
+          
+          workspace.resize(this->_numberOfJoints);
+          
+          for(unsigned int i = first; i < last; ++i) task(workspace, i);
+     });
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Check that a matrix of joint values has a row for every joint                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::check_batch_dimensions(const std::string &functionName,
+                                      const Eigen::MatrixXd &jointValues) const
+{
+     if(jointValues.rows() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] " + functionName + "(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the argument had " + std::to_string(jointValues.rows()) + " rows.");
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute the Jacobian to the specified reference frame                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,Eigen::Dynamic>
+KinematicTree::jacobian(ReferenceFrame *frame)
+{
+    Eigen::Matrix<double,6,Eigen::Dynamic> J = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,this->_numberOfJoints);
+    
+    jacobian(frame, J);                                                                             // NOTE: This can throw an error!
+    
+    return J;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Compute the Jacobian to the specified reference frame in preallocated memory         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::jacobian(ReferenceFrame *frame,
+                        Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] jacobian(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     else if(jacobianMatrix.cols() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] jacobian(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the Jacobian argument had " + std::to_string(jacobianMatrix.cols()) + " columns.");
+     }
+     
+     if(frame->link == nullptr) return;                                                             // Frame is on the base, so nothing moves it
+     
+     Eigen::Vector3d point = (this->_linkPose[this->_topologicalIndex[frame->link->number()]]*frame->relativePose).translation();
+     
+     for(const unsigned int &i : frame->supportingJoints)
+     {
+          unsigned int t = this->_topologicalIndex[i];
+          
+          if(this->_isRevolute[t])
+          {
+               jacobianMatrix.block(0,i,3,1) = this->_jointAxis[t].cross(point - this->_linkPose[t].translation()); // Linear component
+               jacobianMatrix.block(3,i,3,1) = this->_jointAxis[t];                                  // Angular component
+          }
+          else
+          {
+               jacobianMatrix.block(0,i,3,1) = this->_jointAxis[t];                                  // Linear component
+               jacobianMatrix.block(3,i,3,1).setZero();                                              // Angular component
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Compute the non-zero columns of the Jacobian to the specified reference frame        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::compact_jacobian(ReferenceFrame *frame,
+                                Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] compact_jacobian(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     else if(jacobianMatrix.cols() != static_cast<Eigen::Index>(frame->supportingJoints.size()))
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] compact_jacobian(): "
+                                      "This frame is moved by " + std::to_string(frame->supportingJoints.size()) + " joints, but "
+                                      "the Jacobian argument had " + std::to_string(jacobianMatrix.cols()) + " columns.");
+     }
+     
+     if(frame->link == nullptr) return;                                                             // Frame is on the base, so nothing moves it
+     
+     Eigen::Vector3d point = (this->_linkPose[this->_topologicalIndex[frame->link->number()]]*frame->relativePose).translation();
+     
+     for(unsigned int c = 0; c < frame->supportingJoints.size(); ++c)
+     {
+          unsigned int t = this->_topologicalIndex[frame->supportingJoints[c]];
+          
+          if(this->_isRevolute[t])
+          {
+               jacobianMatrix.block(0,c,3,1) = this->_jointAxis[t].cross(point - this->_linkPose[t].translation()); // Linear component
+               jacobianMatrix.block(3,c,3,1) = this->_jointAxis[t];                                  // Angular component
+          }
+          else
+          {
+               jacobianMatrix.block(0,c,3,1) = this->_jointAxis[t];                                  // Linear component
+               jacobianMatrix.block(3,c,3,1).setZero();                                              // Angular component
+          }
+     }
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                            Compute the Jacobian to a given point                              //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double, 6, Eigen::Dynamic>
+KinematicTree::jacobian(Link *link,                                                                 // Starting point in the kinematic tree
+                        const Eigen::Vector3d &point,                                               // A point in the given joint frame
+                        const unsigned int    &numberOfColumns) const                               // Must be less than or equal to number of joints in model
+{
+     if(link->number() > numberOfColumns)
+     {
+          throw std::logic_error("[ERROR] [KINEMATIC TREE] jacobian(): "
+                                 "Cannot compute a Jacobian with " + std::to_string(numberOfColumns) +
+                                 "columns using " + std::to_string(link->number()+1) + " joints.");
+     }
+     else if(numberOfColumns > this->_numberOfJoints)
+     {
+          throw std::logic_error("[ERROR] [KINEMATIC TREE] jacobian(): "
+                                 "A Jacobian matrix with " + std::to_string(numberOfColumns) + " columns was requested, "
+                                 "but this model has only " + std::to_string(this->_numberOfJoints) + " joints.");
+     }
+     
+     Eigen::Matrix<double,6,Eigen::Dynamic> J(6,numberOfColumns);
+     
+     jacobian(this->_topologicalIndex[link->number()], point, J);
+     
+     return J;
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Compute the Jacobian to a given point in preallocated memory                 //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::jacobian(const unsigned int &index,
+                        const Eigen::Vector3d &point,
+                        Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianMatrix) const
+{
+     // Whitney, D. E. (1972)
+     // "The mathematics of coordinated control of prosthetic arms and manipulators"
+     // Journal of Dynamic Systems, Measurement, and Control, pp. 303-309
+     
+     jacobianMatrix.setZero();
+     
+     for(int t = index; t >= 0; t = this->_parentIndex[t])                                          // Move toward the base
+     {
+          unsigned int i = this->_jointNumber[t];
+     
+          if(this->_isRevolute[t])
+          {
+               // J_i = [ a_i x r_i ]
+               //       [    a_i    ]
+          
+               jacobianMatrix.block(0,i,3,1) = this->_jointAxis[t].cross(point - this->_linkPose[t].translation()); // Linear component
+               jacobianMatrix.block(3,i,3,1) = this->_jointAxis[t];                                  // Angular component
+          }
+          else // prismatic
+          {
+               // J_i = [ a_i ]
+               //       [  0  ]
+               
+               jacobianMatrix.block(0,i,3,1) = this->_jointAxis[t];                                  // Linear component
+               jacobianMatrix.block(3,i,3,1).setZero();                                              // Angular component
+          }
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Compute the time derivative of the Jacobian for a reference frame in place            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::jacobian_derivative(ReferenceFrame *frame,
+                                   Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianDerivative) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] jacobian_derivative(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     else if(jacobianDerivative.cols() != this->_numberOfJoints)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] jacobian_derivative(): "
+                                      "This model has " + std::to_string(this->_numberOfJoints) + " joints, but "
+                                      "the matrix argument had " + std::to_string(jacobianDerivative.cols()) + " columns.");
+     }
+     
+     if(frame->link == nullptr) return;                                                             // Frame is on the base, so nothing moves it
+     
+     unsigned int t = this->_topologicalIndex[frame->link->number()];
+     
+     Eigen::Vector3d point = (this->_linkPose[t]*frame->relativePose).translation();
+     
+     Eigen::Vector3d pointVelocity = this->_linkTwist[t].head<3>()
+                                   + this->_linkTwist[t].tail<3>().cross(point - this->_linkPose[t].translation());
+     
+     jacobian_derivative(t, point, pointVelocity, jacobianDerivative);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Compute the acceleration of a reference frame due to the joint velocities             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Vector<double,6>
+KinematicTree::jacobian_derivative_product(ReferenceFrame *frame) const
+{
+     if(frame == nullptr)
+     {
+          throw std::runtime_error("[ERROR] [KINEMATIC TREE] jacobian_derivative_product(): "
+                                   "Pointer to reference frame was empty.");
+     }
+     
+     Eigen::Vector<double,6> product = Eigen::Vector<double,6>::Zero();                             // Value to be returned
+     
+     if(frame->link == nullptr) return product;                                                     // Frame is on the base, so nothing moves it
+     
+     unsigned int k = this->_topologicalIndex[frame->link->number()];
+     
+     Eigen::Vector3d point = (this->_linkPose[k]*frame->relativePose).translation();
+     
+     Eigen::Vector3d pointVelocity = this->_linkTwist[k].head<3>()
+                                   + this->_linkTwist[k].tail<3>().cross(point - this->_linkPose[k].translation());
+     
+     // Sum the columns of Jdot weighted by the joint velocities, from the frame toward the base
+     for(int t = k; t >= 0; t = this->_parentIndex[t])
+     {
+          double qdot = this->_jointVelocity(this->_jointNumber[t]);
+          
+          Eigen::Vector3d axisDerivative = this->_linkTwist[t].tail<3>().cross(this->_jointAxis[t]);
+          
+          if(this->_isRevolute[t])
+          {
+               product.head(3) += qdot*(axisDerivative.cross(point - this->_linkPose[t].translation())
+                                      + this->_jointAxis[t].cross(pointVelocity - this->_linkTwist[t].head<3>()));
+               product.tail(3) += qdot*axisDerivative;
+          }
+          else product.head(3) += qdot*axisDerivative;
+     }
+     
+     return product;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Compute the operational space inertia of a frame                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,6>
+KinematicTree::operational_space_inertia(ReferenceFrame *frame)
+{
+     return operational_space_inertia(std::vector<ReferenceFrame*>{frame});
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute the operational space inertia of several frames                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::operational_space_inertia(const std::vector<ReferenceFrame*> &frames)
+{
+     Eigen::MatrixXd inverse = inverse_operational_space_inertia(frames);
+     
+     return inverse.ldlt().solve(Eigen::MatrixXd::Identity(inverse.rows(), inverse.cols()));       // NOTE: Ill-conditioned near singularities
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Compute the inverse of the operational space inertia of several frames            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::inverse_operational_space_inertia(const std::vector<ReferenceFrame*> &frames)
+{
+     // J*M^-1*J' = (L^-T*J')'*(L^-T*J') where M = L'*L. The rows of J' are only non-zero for
+     // the joints supporting each frame, and L^-T only mixes a joint with its ancestors,
+     // so the factor is applied along each branch without forming or inverting M.
+     
+     Eigen::MatrixXd Y = stacked_jacobian_transpose(frames);
+     
+     update_joint_inertia_factor();
+     
+     factored_inertia_root_solve(this->_jointInertiaFactor, Y);
+     
+     return Y.transpose()*Y;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Compute the dynamically consistent pseudoinverse of the Jacobian               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,Eigen::Dynamic,6>
+KinematicTree::dynamically_consistent_inverse(ReferenceFrame *frame)
+{
+     return dynamically_consistent_inverse(std::vector<ReferenceFrame*>{frame});
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //       Compute the dynamically consistent pseudoinverse of the Jacobians for several frames     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::dynamically_consistent_inverse(const std::vector<ReferenceFrame*> &frames)
+{
+     Eigen::MatrixXd X = stacked_jacobian_transpose(frames);                                        // J' in topological order
+     
+     update_joint_inertia_factor();
+     
+     Eigen::MatrixXd Y = X;
+     
+     factored_inertia_root_solve(this->_jointInertiaFactor, Y);
+     
+     factored_inertia_solve(this->_jointInertiaFactor, X);                                          // M^-1*J'
+     
+     Eigen::MatrixXd inverse = Y.transpose()*Y;                                                     // J*M^-1*J'
+     
+     Eigen::MatrixXd topological = X*inverse.ldlt().solve(Eigen::MatrixXd::Identity(inverse.rows(), inverse.cols()));
+     
+     Eigen::MatrixXd pseudoinverse(this->_numberOfJoints, topological.cols());                      // Value to be returned
+     
+     for(unsigned int t = 0; t < this->_numberOfJoints; ++t) pseudoinverse.row(this->_jointNumber[t]) = topological.row(t);
+     
+     return pseudoinverse;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Stack the transposed Jacobians of several frames, in topological order              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd
+KinematicTree::stacked_jacobian_transpose(const std::vector<ReferenceFrame*> &frames) const
+{
+     if(frames.empty())
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] stacked_jacobian_transpose(): "
+                                      "The list of reference frames was empty.");
+     }
+     
+     Eigen::MatrixXd jacobianTranspose = Eigen::MatrixXd::Zero(this->_numberOfJoints, 6*frames.size()); // Value to be returned
+     
+     Eigen::Matrix<double,6,Eigen::Dynamic> J(6, this->_numberOfJoints);
+     
+     for(unsigned int k = 0; k < frames.size(); ++k)
+     {
+          J.setZero();
+          
+          jacobian(frames[k], J);                                                                   // Only the columns of supporting joints are filled
+          
+          for(unsigned int t = 0; t < this->_numberOfJoints; ++t)
+          {
+               jacobianTranspose.block(t,6*k,1,6) = J.col(this->_jointNumber[t]).transpose();
+          }
+     }
+     
+     return jacobianTranspose;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Compute the time derivative of the Jacobian to a point on a given link             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::jacobian_derivative(const unsigned int &index,
+                                   const Eigen::Vector3d &point,
+                                   const Eigen::Vector3d &pointVelocity,
+                                   Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> jacobianDerivative) const
+{
+     // The axis of each joint is fixed in its link, so it rotates with the link's angular velocity w_i:
+     //
+     // d/dt [ a_i x (p - o_i) ] = [ (w_i x a_i) x (p - o_i) + a_i x (pdot - v_i) ]   (revolute)
+     //      [       a_i       ]   [                 w_i x a_i                   ]
+     //
+     // d/dt [ a_i ] = [ w_i x a_i ]                                                  (prismatic)
+     //      [  0  ]   [     0     ]
+     
+     for(int t = index; t >= 0; t = this->_parentIndex[t])                                          // Move toward the base
+     {
+          unsigned int i = this->_jointNumber[t];
+          
+          Eigen::Vector3d axisDerivative = this->_linkTwist[t].tail<3>().cross(this->_jointAxis[t]);
+          
+          if(this->_isRevolute[t])
+          {
+               jacobianDerivative.block(0,i,3,1) = axisDerivative.cross(point - this->_linkPose[t].translation())
+                                                 + this->_jointAxis[t].cross(pointVelocity - this->_linkTwist[t].head<3>());
+               jacobianDerivative.block(3,i,3,1) = axisDerivative;
+          }
+          else
+          {
+               jacobianDerivative.block(0,i,3,1) = axisDerivative;
+               jacobianDerivative.block(3,i,3,1).setZero();
+          }
+     }
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Get the time derivative of a given Jacobian                           //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double, 6, Eigen::Dynamic>
+KinematicTree::time_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix) const
+{
+     Eigen::Matrix<double,6,Eigen::Dynamic> Jdot(6,jacobianMatrix.cols());
+     
+     time_derivative(jacobianMatrix, Jdot);
+     
+     return Jdot;
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Get the time derivative of a given Jacobian in preallocated memory               //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::time_derivative(const Eigen::Ref<const Eigen::Matrix<double,6,Eigen::Dynamic>> &jacobianMatrix,
+                               Eigen::Ref<Eigen::Matrix<double,6,Eigen::Dynamic>> Jdot) const
+{
+     // An algorithm for computing the time derivative is provided in this reference,
+     // but it's not the same as this one:
+     // Angeles, J. (2003) "Fundamentals of Robotic Mechanical Systems: Theory, Methods, and Algorithms"
+     // Springer
+     
+     Jdot.setZero();
+
+     for(int i = 0; i < jacobianMatrix.cols(); ++i)
+     {
+          for(int j = 0; j <= i; ++j)
+          {
+               // Compute dJ(i)/dq(j)
+               if(this->_joint[j].is_revolute())
+               {
+                    double qdot = this->_jointVelocity(j);                                          // Makes things a little easier
+                    
+                    // qdot_j * ( a_j x (a_i x r_i) )
+                    Jdot(0,i) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i));
+                    Jdot(1,i) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i));
+                    Jdot(2,i) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i));
+                    
+                    if(this->_joint[i].is_revolute())                                               // J_i = [a_i x r_i; a_i]
+                    {
+                         // qdot_j * ( a_j x a_i )
+                         Jdot(3,i) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(5,i) - jacobianMatrix(5,j)*jacobianMatrix(4,i));
+                         Jdot(4,i) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(3,i) - jacobianMatrix(3,j)*jacobianMatrix(5,i));
+                         Jdot(5,i) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(4,i) - jacobianMatrix(4,j)*jacobianMatrix(3,i));
+                    }     
+               }
+               
+               // Compute dJ(j)/dq(i)
+               if(i != j and this->_joint[j].is_revolute())                                         // J_j = [a_j x r_j; a_j]
+               {
+                    double qdot = this->_jointVelocity(i);                                          // Makes things a little easier
+                    
+                    // qdot_i * ( a_j x v_i ), where v_i = a_i x r_i (revolute) or a_i (prismatic)
+                    Jdot(0,j) += qdot*(jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i));
+                    Jdot(1,j) += qdot*(jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i));
+                    Jdot(2,j) += qdot*(jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i));
+               }
+          }
+     }
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Get the partial derivative of a Jacobian with respect to a given joint            //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double, 6, Eigen::Dynamic>
+KinematicTree::partial_derivative(const Eigen::Matrix<double,6,Eigen::Dynamic> &jacobianMatrix,
+                                  const unsigned int &jointNumber)
+{
+
+     // E. D. Pohl and H. Lipkin, "A new method of robotic rate control near singularities,"
+     // Proceedings. 1991 IEEE International Conference on Robotics and Automation,
+     // 1991, pp. 1708-1713 vol.2, doi: 10.1109/ROBOT.1991.131866.
+     
+     unsigned int numberOfColumns = jacobianMatrix.cols();
+     
+     if(jointNumber >= numberOfColumns)
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] partial_derivative(): "
+                                      "Cannot take the derivative with respect to joint number "
+                                      + std::to_string(jointNumber) + " for a Jacobian with only "
+                                      + std::to_string(numberOfColumns) + " columns.");
+     }
+
+     Eigen::Matrix<double,6,Eigen::Dynamic> dJ(6,numberOfColumns);                                  // Value to be returned
+     dJ.setZero();
+     
+     int j = jointNumber;                                                                           // Makes things a little easier
+     
+     for(int i = 0; i < numberOfColumns-1; ++i)
+     {
+          if(this->_joint[i].is_revolute())                                                         // J_i = [a_i x r_i ; a_i]
+          {
+               if(this->_joint[j].is_revolute())                                                    // J_i = [a_j x r_j; a_j]
+               {
+                    if (j < i)
+                    {
+                         // a_j x (a_i x a_i)
+                         dJ(0,i) = jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i);
+                         dJ(1,i) = jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i);
+                         dJ(2,i) = jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i);
+
+                         // a_j x a_i
+                         dJ(3,i) = jacobianMatrix(4,j)*jacobianMatrix(5,i) - jacobianMatrix(5,j)*jacobianMatrix(4,i);
+                         dJ(4,i) = jacobianMatrix(5,j)*jacobianMatrix(3,i) - jacobianMatrix(3,j)*jacobianMatrix(5,i);
+                         dJ(5,i) = jacobianMatrix(3,j)*jacobianMatrix(4,i) - jacobianMatrix(4,j)*jacobianMatrix(3,i);
+                    }
+                    else
+                    {
+                         // a_i x (a_j x a_j)
+                         dJ(0,i) = jacobianMatrix(4,i)*jacobianMatrix(2,j) - jacobianMatrix(5,i)*jacobianMatrix(1,j);
+                         dJ(1,i) = jacobianMatrix(5,i)*jacobianMatrix(0,j) - jacobianMatrix(3,i)*jacobianMatrix(2,j);
+                         dJ(2,i) = jacobianMatrix(3,i)*jacobianMatrix(1,j) - jacobianMatrix(4,i)*jacobianMatrix(0,j);
+                    }
+               }
+               else if(this->_joint[j].is_prismatic() and j > i)                                    // J_j = [a_j ; 0]
+               {
+                    // a_j x a_i
+                    dJ(0,i) = jacobianMatrix(1,j)*jacobianMatrix(2,i) - jacobianMatrix(2,j)*jacobianMatrix(1,i);
+                    dJ(1,i) = jacobianMatrix(2,j)*jacobianMatrix(0,i) - jacobianMatrix(0,j)*jacobianMatrix(2,i);
+                    dJ(2,i) = jacobianMatrix(0,j)*jacobianMatrix(1,i) - jacobianMatrix(1,j)*jacobianMatrix(0,i);
+               }
+          }
+          else if(this->_joint[i].is_prismatic()                                                    // J_i = [a_i ; 0]
+              and this->_joint[j].is_revolute()                                                     // J_j = [a_j x r_j; a_j]
+              and j < i)
+          {
+               // a_j x a_i
+               dJ(0,i) = jacobianMatrix(4,j)*jacobianMatrix(2,i) - jacobianMatrix(5,j)*jacobianMatrix(1,i);
+               dJ(1,i) = jacobianMatrix(5,j)*jacobianMatrix(0,i) - jacobianMatrix(3,j)*jacobianMatrix(2,i);
+               dJ(2,i) = jacobianMatrix(3,j)*jacobianMatrix(1,i) - jacobianMatrix(4,j)*jacobianMatrix(0,i);
+          }
+     }
+     
+     return dJ;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Compute the Jacobian to a given frame                                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,Eigen::Dynamic>
+KinematicTree::jacobian(const std::string &frameName)
+{
+     return jacobian(find_frame(frameName));                                                        // Too easy lol ᕙ(▀̿̿ĺ̯̿̿▀̿ ̿) ᕗ
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Get the pose of a reference frame on the robot                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Pose
 KinematicTree::frame_pose(const std::string &frameName)
 {
      ReferenceFrame *frame = find_frame(frameName);                                                 // Search the model
@@ -627,6 +2564,90 @@ KinematicTree::frame_pose(const std::string &frameName)
      return frame->link->pose()*frame->relativePose;                                                // Return pose relative to base/global frame
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Get the pose of a reference frame by its number                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+const Pose&
+KinematicTree::frame_pose(const FrameID &frameID)
+{
+     if(frameID.number >= this->_frameHandle.size())
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] frame_pose(): "
+                                      "There are only " + std::to_string(this->_frameHandle.size()) + " frames in this model, "
+                                      "but the frame number was " + std::to_string(frameID.number) + ".");
+     }
+     
+     if(not this->_frameIsCached[frameID.number]) update_frame_pose(frameID.number);
+     
+     return this->_framePose[frameID.number];
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Get the Jacobian for a reference frame by its number                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,Eigen::Dynamic>
+KinematicTree::jacobian(const FrameID &frameID)
+{
+     if(frameID.number >= this->_frameHandle.size())
+     {
+          throw std::invalid_argument("[ERROR] [KINEMATIC TREE] jacobian(): "
+                                      "There are only " + std::to_string(this->_frameHandle.size()) + " frames in this model, "
+                                      "but the frame number was " + std::to_string(frameID.number) + ".");
+     }
+     
+     return jacobian(this->_frameHandle[frameID.number]);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                           Get the number for a reference frame                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+FrameID
+KinematicTree::frame_id(const std::string &frameName) const
+{
+     const ReferenceFrame *frame = find_frame(frameName);                                           // NOTE: This can throw an error!
+     
+     return FrameID{(unsigned int)(std::find(this->_frameHandle.begin(), this->_frameHandle.end(), frame) - this->_frameHandle.begin())};
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Compute the pose of a reference frame every time the state is updated         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+KinematicTree::cache_frame_pose(const FrameID &frameID)
+{
+     if(frameID.number >= this->_frameHandle.size())
+     {
+          std::cerr << "[ERROR] [KINEMATIC TREE] cache_frame_pose(): "
+                    << "There are only " << this->_frameHandle.size() << " frames in this model, "
+                    << "but the frame number was " << frameID.number << "." << std::endl;
+          
+          return false;
+     }
+     
+     if(not this->_frameIsCached[frameID.number])
+     {
+          this->_frameIsCached[frameID.number] = true;
+          
+          this->_cachedFrames.push_back(frameID.number);
+          
+          update_frame_pose(frameID.number);                                                        // So it is valid before the next update
+     }
+     
+     return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Compute the pose of a reference frame from the link states                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+KinematicTree::update_frame_pose(const unsigned int &frameID)
+{
+     const ReferenceFrame *frame = this->_frameHandle[frameID];
+     
+     if(frame->link == nullptr) this->_framePose[frameID] = this->base.pose()*frame->relativePose;  // Frame is on the base
+     else this->_framePose[frameID] = this->_linkPose[this->_topologicalIndex[frame->link->number()]]*frame->relativePose;
+}
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                                 Return a pointer to a link                                     //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -647,6 +2668,15 @@ KinematicTree::link(const unsigned int &linkNumber)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ReferenceFrame*
 KinematicTree::find_frame(const std::string &frameName)
+{
+   return const_cast<ReferenceFrame*>(static_cast<const KinematicTree*>(this)->find_frame(frameName));
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Find a reference frame on a shared, const model by name                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+const ReferenceFrame*
+KinematicTree::find_frame(const std::string &frameName) const
 {
    auto container = this->_frameList.find(frameName);                                               // Find the frame in the list
    
@@ -80,7 +80,7 @@ Pose::operator*= (const Pose &other)
  //                                    Transform a vector                                         //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 Eigen::Vector<double,3>
-Pose::operator* (const Eigen::Vector<double,3> &other)
+Pose::operator* (const Eigen::Vector<double,3> &other) const
 {
      return this->_translation + this->_quaternion.toRotationMatrix()*other;
 }
@@ -0,0 +1,120 @@
+/**
+ * @file   WorkerPool.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Source files for the WorkerPool class.
+ */
+
+#include "WorkerPool.h"
+
+namespace RobotLibrary {
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                          Constructor                                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+WorkerPool::WorkerPool(const unsigned int &numberOfThreads)
+{
+     for(unsigned int k = 1; k < numberOfThreads; ++k)                                              // The caller is the first thread
+     {
+          this->_threads.emplace_back(&WorkerPool::work, this);
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                          Destructor                                            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+WorkerPool::~WorkerPool()
+{
+     {
+          std::lock_guard<std::mutex> lock(this->_mutex);
+
+          this->_stop = true;
+     }
+
+     this->_taskAvailable.notify_all();
+
+     for(auto &thread : this->_threads) thread.join();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Evaluate a number of tasks and wait for them to finish                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+WorkerPool::run(const unsigned int &numberOfTasks,
+                const std::function<void(const unsigned int&)> &task)
+{
+     if(numberOfTasks == 0) return;
+
+     std::lock_guard<std::mutex> runLock(this->_runMutex);
+
+     std::unique_lock<std::mutex> lock(this->_mutex);
+
+     this->_task            = &task;
+     this->_numberOfTasks   = numberOfTasks;
+     this->_nextTask        = 0;
+     this->_unfinishedTasks = numberOfTasks;
+     this->_error           = nullptr;
+
+     if(numberOfTasks > 1) this->_taskAvailable.notify_all();
+
+     evaluate_tasks(lock);                                                                          // Do some of the work on this thread
+
+     this->_tasksFinished.wait(lock, [this]{ return this->_unfinishedTasks == 0; });                // Barrier
+
+     this->_task = nullptr;
+
+     if(this->_error) std::rethrow_exception(this->_error);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Take tasks from the current run until none are left                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+WorkerPool::evaluate_tasks(std::unique_lock<std::mutex> &lock)
+{
+     while(this->_nextTask < this->_numberOfTasks)
+     {
+          unsigned int index = this->_nextTask++;
+
+          const std::function<void(const unsigned int&)> &task = *this->_task;
+
+          lock.unlock();
+
+          std::exception_ptr error;
+
+          try
+          {
+               task(index);
+          }
+          catch(...)
+          {
+               error = std::current_exception();
+          }
+
+          lock.lock();
+
+          if(error and not this->_error) this->_error = error;                                      // Keep the first one
+
+          if(--this->_unfinishedTasks == 0) this->_tasksFinished.notify_all();
+     }
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                The loop for each worker thread                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+WorkerPool::work()
+{
+     std::unique_lock<std::mutex> lock(this->_mutex);
+
+     while(true)
+     {
+          this->_taskAvailable.wait(lock, [this]{ return this->_stop or this->_nextTask < this->_numberOfTasks; });
+
+          if(this->_stop) return;
+
+          evaluate_tasks(lock);
+     }
+}
+
+}
@@ -0,0 +1,137 @@
+/**
+ * @file   TestModels.h
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Writes simple URDF models for the tests and benchmarks.
+ */
+
+#ifndef TESTMODELS_H_
+#define TESTMODELS_H_
+
+#include <fstream>                                                                                  // std::ofstream
+#include <string>                                                                                   // std::string, std::to_string
+
+namespace RobotLibrary { namespace Test {
+
+/**
+ * Write a link with some mass and inertia, offset along its z-axis.
+ */
+inline void
+write_link(std::ofstream &file, const std::string &name)
+{
+     file << "  <link name=\"" << name << "\">\n"
+          << "    <inertial>\n"
+          << "      <origin xyz=\"0.01 0.02 0.10\" rpy=\"0 0 0\"/>\n"
+          << "      <mass value=\"1.5\"/>\n"
+          << "      <inertia ixx=\"0.02\" ixy=\"0.001\" ixz=\"0.0\" iyy=\"0.03\" iyz=\"0.002\" izz=\"0.01\"/>\n"
+          << "    </inertial>\n"
+          << "  </link>\n";
+}
+
+/**
+ * Write a revolute joint. The axes alternate so that the model is not planar.
+ */
+inline void
+write_joint(std::ofstream &file, const std::string &name, const std::string &parent, const std::string &child, const unsigned int &number)
+{
+     const char* axes[] = {"0 0 1", "0 1 0", "1 0 0"};
+     
+     file << "  <joint name=\"" << name << "\" type=\"revolute\">\n"
+          << "    <parent link=\"" << parent << "\"/>\n"
+          << "    <child link=\"" << child << "\"/>\n"
+          << "    <origin xyz=\"0 0.05 0.2\" rpy=\"0.1 0 0.2\"/>\n"
+          << "    <axis xyz=\"" << axes[number % 3] << "\"/>\n"
+          << "    <limit lower=\"-3.0\" upper=\"3.0\" velocity=\"2.0\" effort=\"100\"/>\n"
+          << "    <dynamics damping=\"0.5\" friction=\"0.0\"/>\n"
+          << "  </joint>\n";
+}
+
+/**
+ * Write a serial link robot with a fixed frame called "endpoint" on the last link.
+ * @param path Where to write the file.
+ * @param numberOfJoints As it says.
+ * @return The path, so it can be passed straight to the KinematicTree constructor.
+ */
+inline std::string
+write_serial_robot(const std::string &path, const unsigned int &numberOfJoints)
+{
+     std::ofstream file(path);
+     
+     file << "<?xml version=\"1.0\"?>\n<robot name=\"serial_" << numberOfJoints << "\">\n";
+     
+     write_link(file, "link0");
+     
+     for(unsigned int i = 1; i <= numberOfJoints; ++i)
+     {
+          write_link(file, "link" + std::to_string(i));
+          write_joint(file, "joint" + std::to_string(i), "link" + std::to_string(i-1), "link" + std::to_string(i), i);
+     }
+     
+     file << "  <link name=\"endpoint\"/>\n"
+          << "  <joint name=\"endpoint_joint\" type=\"fixed\">\n"
+          << "    <parent link=\"link" << numberOfJoints << "\"/>\n"
+          << "    <child link=\"endpoint\"/>\n"
+          << "    <origin xyz=\"0 0 0.1\" rpy=\"0 0 0\"/>\n"
+          << "  </joint>\n"
+          << "</robot>\n";
+     
+     return path;
+}
+
+/**
+ * Write a tree with a serial trunk and several serial branches, e.g. a humanoid.
+ * Each branch ends in a fixed frame called "endpoint<k>".
+ * @param path Where to write the file.
+ * @param trunkLength Number of joints before the tree branches.
+ * @param numberOfBranches As it says.
+ * @param branchLength Number of joints in each branch.
+ * @return The path, so it can be passed straight to the KinematicTree constructor.
+ */
+inline std::string
+write_branched_robot(const std::string  &path,
+                     const unsigned int &trunkLength,
+                     const unsigned int &numberOfBranches,
+                     const unsigned int &branchLength)
+{
+     std::ofstream file(path);
+     
+     file << "<?xml version=\"1.0\"?>\n<robot name=\"branched\">\n";
+     
+     write_link(file, "trunk0");
+     
+     for(unsigned int i = 1; i <= trunkLength; ++i)
+     {
+          write_link(file, "trunk" + std::to_string(i));
+          write_joint(file, "trunk_joint" + std::to_string(i), "trunk" + std::to_string(i-1), "trunk" + std::to_string(i), i);
+     }
+     
+     for(unsigned int k = 0; k < numberOfBranches; ++k)
+     {
+          std::string parent = "trunk" + std::to_string(trunkLength);
+          
+          for(unsigned int i = 1; i <= branchLength; ++i)
+          {
+               std::string child = "branch" + std::to_string(k) + "_" + std::to_string(i);
+               
+               write_link(file, child);
+               write_joint(file, child + "_joint", parent, child, k + i);
+               
+               parent = child;
+          }
+          
+          file << "  <link name=\"endpoint" << k << "\"/>\n"
+               << "  <joint name=\"endpoint" << k << "_joint\" type=\"fixed\">\n"
+               << "    <parent link=\"" << parent << "\"/>\n"
+               << "    <child link=\"endpoint" << k << "\"/>\n"
+               << "    <origin xyz=\"0 0 0.1\" rpy=\"0 0 0\"/>\n"
+               << "  </joint>\n";
+     }
+     
+     file << "</robot>\n";
+     
+     return path;
+}
+
+} }                                                                                                 // namespace RobotLibrary::Test
+
+#endif
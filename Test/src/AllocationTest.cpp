@@ -0,0 +1,84 @@
+/**
+ * @file   AllocationTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks that the kinematics and dynamics of a model do not allocate on the heap.
+ *
+ * This is compiled with EIGEN_RUNTIME_NO_MALLOC and assertions enabled,
+ * so Eigen aborts the test if memory is allocated where it is forbidden.
+ */
+
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <iostream>
+
+using namespace RobotLibrary;
+
+int main()
+{
+     int failures = 0;
+     
+     for(unsigned int n : {6, 7, 12})
+     {
+          if(MaxJoints != Eigen::Dynamic and int(n) > MaxJoints) continue;                          // Too big for this build
+          
+          KinematicTree model(Test::write_serial_robot("allocation_test_" + std::to_string(n) + ".urdf", n));
+          
+          ReferenceFrame *endpoint = model.find_frame("endpoint");
+          
+          Eigen::VectorXd jointPosition = Eigen::VectorXd::Constant(n, 0.3);
+          Eigen::VectorXd jointVelocity = Eigen::VectorXd::Constant(n,-0.2);
+          
+          Eigen::Matrix<double,6,Eigen::Dynamic> jacobianMatrix     = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,n);
+          Eigen::Matrix<double,6,Eigen::Dynamic> jacobianDerivative = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,n);
+          
+          for(bool eager : {false, true})
+          {
+               if(eager) model.use_eager_dynamics();
+               else      model.use_lazy_dynamics();
+               
+               for(unsigned int i = 0; i < 100; ++i)
+               {
+                    jointPosition(i % n) = 0.01*i;
+                    
+                    model.update_state(jointPosition, jointVelocity);                               // Forbids allocation inside
+                    
+                    Eigen::internal::set_is_malloc_allowed(false);
+                    
+                    model.jacobian(endpoint, jacobianMatrix);
+                    model.jacobian_derivative(endpoint, jacobianDerivative);
+                    model.joint_inertia_matrix();
+                    model.joint_coriolis_vector();
+                    model.joint_gravity_vector();
+                    
+                    Eigen::internal::set_is_malloc_allowed(true);
+               }
+          }
+          
+          // An error inside update_state() must not leave allocation switched off
+          jointPosition(0) = 10.0;                                                                  // Outside the joint limit
+          
+          try
+          {
+               model.update_state(jointPosition, jointVelocity);
+               
+               std::cerr << "[FAILED] update_state() did not throw for a joint outside its limits.\n";
+               
+               failures++;
+          }
+          catch(const std::exception &exception)
+          {
+               if(not Eigen::internal::is_malloc_allowed())
+               {
+                    std::cerr << "[FAILED] Allocation was still forbidden after update_state() threw.\n";
+                    
+                    failures++;
+               }
+          }
+          
+          std::cout << "[INFO] " << n << " joints: done.\n";
+     }
+     
+     return failures;
+}
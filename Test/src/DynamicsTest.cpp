@@ -0,0 +1,439 @@
+/**
+ * @file   DynamicsTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks the dynamics algorithms against each other and against dense references.
+ *
+ * Each check runs on a serial arm and a branched tree from TestModels.h, at several random states.
+ */
+
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <algorithm>                                                                                // std::max
+#include <iostream>
+
+using namespace RobotLibrary;
+
+/**
+ * Print a message if two results differ by more than a tolerance, relative to the size of the expected one.
+ * @return 1 if they differ, so it can be added to the failures.
+ */
+int
+expect_near(const std::string     &what,
+            const Eigen::MatrixXd &result,
+            const Eigen::MatrixXd &expected,
+            const double          &tolerance = 1e-09)
+{
+     double error = (result - expected).norm() / std::max(1.0, expected.norm());
+
+     if(error <= tolerance) return 0;
+
+     std::cerr << "[FAILED] " << what << ": the relative error was " << error << ".\n";
+
+     return 1;
+}
+
+/**
+ * The recursive Newton-Euler algorithm should match tau = M*qddot + C*qdot + D*qdot + g from update_state().
+ */
+int
+check_inverse_dynamics(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     Eigen::MatrixXd jointPositions(n,3), jointVelocities(n,3), jointAccelerations(n,3), expectedTorques(n,3);
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qddot = Eigen::VectorXd::Random(n);
+
+          model.update_state(q, qdot);
+
+          Eigen::VectorXd expected = model.joint_inertia_matrix()*qddot
+                                   + model.joint_coriolis_matrix()*qdot
+                                   + model.joint_damping_vector()
+                                   + model.joint_gravity_vector();
+
+          failures += expect_near(model.name() + " inverse_dynamics()", model.inverse_dynamics(q, qdot, qddot), expected);
+
+          failures += expect_near(model.name() + " gravity_torques()", model.gravity_torques(q), model.joint_gravity_vector());
+
+          jointPositions.col(k) = q;
+          jointVelocities.col(k) = qdot;
+          jointAccelerations.col(k) = qddot;
+          expectedTorques.col(k) = expected;
+     }
+
+     failures += expect_near(model.name() + " batch_inverse_dynamics()",
+                             model.batch_inverse_dynamics(jointPositions, jointVelocities, jointAccelerations),
+                             expectedTorques);
+
+     return failures;
+}
+
+/**
+ * The composite rigid body algorithm should give a symmetric, positive definite matrix whose
+ * columns are the torques from the recursive Newton-Euler algorithm for a unit acceleration of each joint.
+ */
+int
+check_joint_inertia_matrix(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     KinematicTreeData data = model.make_data();
+
+     Eigen::MatrixXd jointPositions(n,3), expectedInertias(3*n,n);
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+
+          model.update_state(q, Eigen::VectorXd::Zero(n));
+
+          Eigen::MatrixXd M = model.joint_inertia_matrix();
+
+          // With zero velocity, tau = M*qddot + g, so column j of M is tau(e_j) - g
+          Eigen::MatrixXd expected(n,n);
+          Eigen::VectorXd gravity = model.inverse_dynamics(q, Eigen::VectorXd::Zero(n), Eigen::VectorXd::Zero(n));
+
+          for(unsigned int j = 0; j < n; ++j)
+          {
+               expected.col(j) = model.inverse_dynamics(q, Eigen::VectorXd::Zero(n), Eigen::VectorXd::Unit(n,j)) - gravity;
+          }
+
+          failures += expect_near(model.name() + " joint_inertia_matrix()", M, expected);
+
+          failures += expect_near(model.name() + " joint_inertia_matrix() symmetry", M, M.transpose(), 1e-12);
+
+          if(M.llt().info() != Eigen::Success)
+          {
+               std::cerr << "[FAILED] " << model.name() << " joint_inertia_matrix() is not positive definite.\n";
+
+               failures++;
+          }
+
+          model.update_state(q, Eigen::VectorXd::Zero(n), data);
+
+          failures += expect_near(model.name() + " joint_inertia_matrix(data)", model.joint_inertia_matrix(data), expected);
+
+          jointPositions.col(k) = q;
+          expectedInertias.middleRows(k*n,n) = expected;
+     }
+
+     failures += expect_near(model.name() + " batch_joint_inertia_matrix()", model.batch_joint_inertia_matrix(jointPositions), expectedInertias);
+
+     return failures;
+}
+
+/**
+ * The articulated body algorithm should invert the recursive Newton-Euler algorithm,
+ * and match qddot = M^-1*(tau - C*qdot - D*qdot - g) from update_state().
+ */
+int
+check_forward_dynamics(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd tau = 10.0*Eigen::VectorXd::Random(n);
+
+          Eigen::VectorXd qddot = model.forward_dynamics(q, qdot, tau);
+
+          failures += expect_near(model.name() + " inverse_dynamics(forward_dynamics())", model.inverse_dynamics(q, qdot, qddot), tau);
+
+          model.update_state(q, qdot);
+
+          Eigen::VectorXd expected = model.joint_inertia_matrix().ldlt().solve(tau
+                                   - model.joint_coriolis_matrix()*qdot
+                                   - model.joint_damping_vector()
+                                   - model.joint_gravity_vector());
+
+          failures += expect_near(model.name() + " forward_dynamics()", qddot, expected);
+     }
+
+     return failures;
+}
+
+/**
+ * The Coriolis vector should equal C*qdot, and Mdot - 2*C should be skew symmetric,
+ * where Mdot is a central difference of the inertia matrix along the joint velocity.
+ */
+int
+check_coriolis(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     const double h = 1e-06;                                                                        // Step size for the finite difference
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+
+          model.update_state(q + h*qdot, qdot);
+          Eigen::MatrixXd M1 = model.joint_inertia_matrix();
+
+          model.update_state(q - h*qdot, qdot);
+          Eigen::MatrixXd M0 = model.joint_inertia_matrix();
+
+          Eigen::MatrixXd Mdot = (M1 - M0)/(2*h);
+
+          model.update_state(q, qdot);
+
+          Eigen::MatrixXd C = model.joint_coriolis_matrix();
+
+          Eigen::MatrixXd N = Mdot - 2*C;
+
+          failures += expect_near(model.name() + " Mdot - 2*C skew symmetry", N, -N.transpose(), 1e-06);
+
+          failures += expect_near(model.name() + " joint_coriolis_vector()", model.joint_coriolis_vector(), C*qdot);
+     }
+
+     return failures;
+}
+
+/**
+ * The analytical derivatives of the inverse and forward dynamics should match central differences.
+ */
+int
+check_dynamics_derivatives(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     const double h = 1e-06;                                                                        // Step size for the finite differences
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qddot = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd tau = 10.0*Eigen::VectorXd::Random(n);
+
+          Eigen::MatrixXd expectedTorqueByPosition(n,n), expectedTorqueByVelocity(n,n);
+          Eigen::MatrixXd expectedAccelerationByPosition(n,n), expectedAccelerationByVelocity(n,n);
+
+          for(unsigned int j = 0; j < n; ++j)
+          {
+               Eigen::VectorXd dx = h*Eigen::VectorXd::Unit(n,j);
+
+               expectedTorqueByPosition.col(j) = (model.inverse_dynamics(q + dx, qdot, qddot)
+                                                - model.inverse_dynamics(q - dx, qdot, qddot))/(2*h);
+
+               expectedTorqueByVelocity.col(j) = (model.inverse_dynamics(q, qdot + dx, qddot)
+                                                - model.inverse_dynamics(q, qdot - dx, qddot))/(2*h);
+
+               expectedAccelerationByPosition.col(j) = (model.forward_dynamics(q + dx, qdot, tau)
+                                                      - model.forward_dynamics(q - dx, qdot, tau))/(2*h);
+
+               expectedAccelerationByVelocity.col(j) = (model.forward_dynamics(q, qdot + dx, tau)
+                                                      - model.forward_dynamics(q, qdot - dx, tau))/(2*h);
+          }
+
+          Eigen::MatrixXd torqueByPosition, torqueByVelocity;
+
+          model.inverse_dynamics_derivatives(q, qdot, qddot, torqueByPosition, torqueByVelocity);
+
+          failures += expect_near(model.name() + " d(tau)/dq", torqueByPosition, expectedTorqueByPosition, 1e-06);
+
+          failures += expect_near(model.name() + " d(tau)/d(qdot)", torqueByVelocity, expectedTorqueByVelocity, 1e-06);
+
+          Eigen::MatrixXd accelerationByPosition, accelerationByVelocity, accelerationByTorque;
+
+          model.forward_dynamics_derivatives(q, qdot, tau, accelerationByPosition, accelerationByVelocity, accelerationByTorque);
+
+          failures += expect_near(model.name() + " d(qddot)/dq", accelerationByPosition, expectedAccelerationByPosition, 1e-06);
+
+          failures += expect_near(model.name() + " d(qddot)/d(qdot)", accelerationByVelocity, expectedAccelerationByVelocity, 1e-06);
+
+          model.update_state(q, qdot);
+
+          failures += expect_near(model.name() + " d(qddot)/d(tau)", accelerationByTorque*model.joint_inertia_matrix(), Eigen::MatrixXd::Identity(n,n));
+     }
+
+     return failures;
+}
+
+/**
+ * Solving with the factor of the inertia matrix along the branches should match a dense solve with M.ldlt().
+ */
+int
+check_joint_inertia_solve(KinematicTree &model)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          model.update_state(Eigen::VectorXd::Random(n), Eigen::VectorXd::Random(n));
+
+          Eigen::MatrixXd B = Eigen::MatrixXd::Random(n,4);
+
+          Eigen::MatrixXd expected = model.joint_inertia_matrix().ldlt().solve(B);
+
+          failures += expect_near(model.name() + " joint_inertia_solve()", model.joint_inertia_solve(B), expected);
+
+          Eigen::MatrixXd Y = model.joint_inertia_factor_solve(B);                                  // M = L'*L, so Y'*Y = B'*M^-1*B
+
+          failures += expect_near(model.name() + " joint_inertia_factor_solve()", Y.transpose()*Y, B.transpose()*expected);
+     }
+
+     return failures;
+}
+
+/**
+ * The operational space inertia should match the dense (J*M^-1*J')^-1, and the dynamically consistent
+ * inverse should match M^-1*J'*Lambda. The frames must have at least 6 joints each between them.
+ */
+int
+check_operational_space_inertia(KinematicTree &model, const std::vector<std::string> &frameNames)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     std::vector<ReferenceFrame*> frames;
+     for(const std::string &frameName : frameNames) frames.push_back(model.find_frame(frameName));
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          model.update_state(Eigen::VectorXd::Random(n), Eigen::VectorXd::Random(n));
+
+          Eigen::MatrixXd J(6*frames.size(), n);
+          for(unsigned int i = 0; i < frames.size(); ++i) J.middleRows(6*i,6) = model.jacobian(frames[i]);
+
+          Eigen::MatrixXd invM = model.joint_inertia_matrix().inverse();
+
+          Eigen::MatrixXd expectedInverse = J*invM*J.transpose();
+
+          Eigen::MatrixXd expected = expectedInverse.inverse();
+
+          failures += expect_near(model.name() + " inverse_operational_space_inertia()",
+                                  model.inverse_operational_space_inertia(frames), expectedInverse);
+
+          failures += expect_near(model.name() + " operational_space_inertia()", model.operational_space_inertia(frames), expected, 1e-06);
+
+          failures += expect_near(model.name() + " dynamically_consistent_inverse()",
+                                  model.dynamically_consistent_inverse(frames), invM*J.transpose()*expected, 1e-06);
+
+          for(unsigned int i = 0; i < frames.size(); ++i)
+          {
+               std::string what = model.name() + " " + frameNames[i];
+
+               Eigen::MatrixXd Ji = J.middleRows(6*i,6);
+
+               Eigen::MatrixXd Lambda = (Ji*invM*Ji.transpose()).inverse();
+
+               failures += expect_near(what + " operational_space_inertia()", model.operational_space_inertia(frames[i]), Lambda, 1e-06);
+
+               failures += expect_near(what + " dynamically_consistent_inverse()",
+                                       model.dynamically_consistent_inverse(frames[i]), invM*Ji.transpose()*Lambda, 1e-06);
+          }
+     }
+
+     return failures;
+}
+
+/**
+ * The center of mass Jacobian should match a central difference of the center of mass, and the centroidal
+ * momentum should give the generalised momentum M*qdot of the first joint, which carries every moving link.
+ */
+int
+check_centroidal_terms(KinematicTree &model, const std::string &frameName)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     const double h = 1e-06;                                                                        // Step size for the finite difference
+
+     ReferenceFrame *frame = model.find_frame(frameName);
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+
+          model.update_state(q + h*qdot, qdot);
+          Eigen::Vector3d c1 = model.center_of_mass();
+
+          model.update_state(q - h*qdot, qdot);
+          Eigen::Vector3d c0 = model.center_of_mass();
+
+          model.update_state(q, qdot);
+
+          failures += expect_near(model.name() + " total_mass()", Eigen::Matrix<double,1,1>(model.total_mass()),
+                                  Eigen::Matrix<double,1,1>(1.5*(n + 1)));                          // Every link in TestModels.h is 1.5 kg
+
+          failures += expect_near(model.name() + " center_of_mass_jacobian()", model.center_of_mass_jacobian()*qdot, (c1 - c0)/(2*h), 1e-06);
+
+          Eigen::Vector<double,6> momentum = model.centroidal_momentum_matrix()*qdot;
+
+          failures += expect_near(model.name() + " linear momentum", momentum.head(3), model.total_mass()*model.center_of_mass_jacobian()*qdot);
+
+          // The momentum of joint 1 is its axis s dotted with the angular momentum about a point p on the axis,
+          // i.e. s'*(L + (c - p) x P). The Jacobian of any frame e gives s, and s x (e - p) in its first column.
+          Eigen::Matrix<double,6,Eigen::Dynamic> J = model.jacobian(frame);
+
+          Eigen::Vector3d axis = J.col(0).tail(3);
+          Eigen::Vector3d linearMomentum = momentum.head(3);
+
+          double expected = axis.dot(momentum.tail(3))
+                          + linearMomentum.dot(axis.cross(model.center_of_mass() - model.frame_pose(frameName).translation()))
+                          + linearMomentum.dot(J.col(0).head(3));
+
+          failures += expect_near(model.name() + " angular momentum", Eigen::Matrix<double,1,1>(expected),
+                                  (model.joint_inertia_matrix()*qdot).head(1));
+     }
+
+     return failures;
+}
+
+int main()
+{
+     int failures = 0;
+
+     KinematicTree serial(Test::write_serial_robot("dynamics_test_serial.urdf", 7));
+     KinematicTree branched(Test::write_branched_robot("dynamics_test_branched.urdf", 2, 2, 5));
+
+     for(KinematicTree *model : {&serial, &branched})
+     {
+          failures += check_inverse_dynamics(*model);
+
+          failures += check_joint_inertia_matrix(*model);
+
+          failures += check_forward_dynamics(*model);
+
+          failures += check_coriolis(*model);
+
+          failures += check_dynamics_derivatives(*model);
+
+          failures += check_joint_inertia_solve(*model);
+     }
+
+     failures += check_operational_space_inertia(serial, {"endpoint"});
+     failures += check_operational_space_inertia(branched, {"endpoint0", "endpoint1"});             // 12 joints for 12 rows
+
+     failures += check_centroidal_terms(serial, "endpoint");
+     failures += check_centroidal_terms(branched, "endpoint0");
+
+     if(failures == 0) std::cout << "[INFO] All the dynamics agree.\n";
+
+     return failures;
+}
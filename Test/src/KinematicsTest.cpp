@@ -0,0 +1,273 @@
+/**
+ * @file   KinematicsTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks the kinematics of the reference frames against finite differences and against update_state().
+ *
+ * Each check runs on a serial arm and a branched tree from TestModels.h, at several random states.
+ */
+
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <algorithm>                                                                                // std::max
+#include <iostream>
+
+using namespace RobotLibrary;
+
+/**
+ * Print a message if two results differ by more than a tolerance, relative to the size of the expected one.
+ * @return 1 if they differ, so it can be added to the failures.
+ */
+int
+expect_near(const std::string     &what,
+            const Eigen::MatrixXd &result,
+            const Eigen::MatrixXd &expected,
+            const double          &tolerance = 1e-09)
+{
+     double error = (result - expected).norm() / std::max(1.0, expected.norm());
+
+     if(error <= tolerance) return 0;
+
+     std::cerr << "[FAILED] " << what << ": the relative error was " << error << ".\n";
+
+     return 1;
+}
+
+/**
+ * Put the rotation and translation of a pose side by side, so that two poses can be compared with expect_near().
+ */
+Eigen::Matrix<double,3,4>
+pose_matrix(const Pose &pose)
+{
+     Eigen::Matrix<double,3,4> matrix;
+     matrix << pose.rotation(), pose.translation();
+     return matrix;
+}
+
+/**
+ * The time derivative of the Jacobian should match a central difference along the joint velocity.
+ */
+int
+check_jacobian_derivative(KinematicTree &model, const std::vector<std::string> &frameNames)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     const double h = 1e-06;                                                                        // Step size for the finite difference
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+
+          for(const std::string &frameName : frameNames)
+          {
+               ReferenceFrame *frame = model.find_frame(frameName);
+
+               model.update_state(q + h*qdot, qdot);
+               Eigen::MatrixXd J1 = model.jacobian(frame);
+
+               model.update_state(q - h*qdot, qdot);
+               Eigen::MatrixXd J0 = model.jacobian(frame);
+
+               Eigen::MatrixXd expected = (J1 - J0)/(2*h);
+
+               model.update_state(q, qdot);
+
+               Eigen::Matrix<double,6,Eigen::Dynamic> Jdot = Eigen::Matrix<double,6,Eigen::Dynamic>::Zero(6,n);
+
+               model.jacobian_derivative(frame, Jdot);
+
+               std::string what = model.name() + " " + frameName;
+
+               failures += expect_near(what + " jacobian_derivative()", Jdot, expected, 1e-06);
+
+               failures += expect_near(what + " time_derivative()", model.time_derivative(model.jacobian(frame)), expected, 1e-06);
+
+               failures += expect_near(what + " jacobian_derivative_product()", model.jacobian_derivative_product(frame), Jdot*qdot);
+          }
+     }
+
+     return failures;
+}
+
+/**
+ * A cached frame pose should be updated by every call to update_state(), and match the pose computed from its link.
+ * Only some of the frames are cached, so both paths of frame_pose() are checked.
+ */
+int
+check_cached_frame_poses(KinematicTree &model, const std::vector<std::string> &frameNames)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     std::vector<FrameID> frameIDs;
+
+     for(unsigned int i = 0; i < frameNames.size(); ++i)
+     {
+          frameIDs.push_back(model.frame_id(frameNames[i]));
+
+          if(i % 2 == 0 and not model.cache_frame_pose(frameIDs[i]))
+          {
+               std::cerr << "[FAILED] " << model.name() << " could not cache the pose of " << frameNames[i] << ".\n";
+
+               failures++;
+          }
+     }
+
+     if(model.cache_frame_pose(FrameID{100}))                                                       // Out of range, so it prints an error
+     {
+          std::cerr << "[FAILED] " << model.name() << " cached the pose of a frame that does not exist.\n";
+
+          failures++;
+     }
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          model.update_state(Eigen::VectorXd::Random(n), Eigen::VectorXd::Random(n));
+
+          for(unsigned int i = 0; i < frameNames.size(); ++i)
+          {
+               std::string what = model.name() + " " + frameNames[i];
+
+               failures += expect_near(what + " frame_pose(FrameID)", pose_matrix(model.frame_pose(frameIDs[i])), pose_matrix(model.frame_pose(frameNames[i])));
+
+               failures += expect_near(what + " jacobian(FrameID)", model.jacobian(frameIDs[i]), model.jacobian(frameNames[i]));
+          }
+     }
+
+     return failures;
+}
+
+/**
+ * The batch kinematics, which evaluate several configurations at once in SIMD registers, should match
+ * update_state() on each configuration. The number of configurations is not a multiple of the lanes.
+ */
+int
+check_batch_kinematics(KinematicTree &model, const std::vector<std::string> &frameNames)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     const unsigned int m = 7;
+
+     Eigen::MatrixXd jointPositions = Eigen::MatrixXd::Random(n,m);
+
+     Eigen::MatrixXd linkPositions, linkRotations;
+
+     model.batch_forward_kinematics(jointPositions, linkPositions, linkRotations);
+
+     for(const std::string &frameName : frameNames)
+     {
+          ReferenceFrame *frame = model.find_frame(frameName);
+
+          std::vector<Pose> framePoses = model.batch_frame_pose(frame, jointPositions);
+
+          Eigen::MatrixXd jacobians = model.batch_jacobian(frame, jointPositions);
+
+          for(unsigned int j = 0; j < m; ++j)
+          {
+               model.update_state(jointPositions.col(j), Eigen::VectorXd::Zero(n));
+
+               std::string what = model.name() + " " + frameName + " configuration " + std::to_string(j);
+
+               failures += expect_near(what + " batch_frame_pose()", pose_matrix(framePoses[j]), pose_matrix(model.frame_pose(frameName)));
+
+               failures += expect_near(what + " batch_jacobian()", jacobians.middleRows(6*j,6), model.jacobian(frame));
+          }
+     }
+
+     for(unsigned int j = 0; j < m; ++j)
+     {
+          model.update_state(jointPositions.col(j), Eigen::VectorXd::Zero(n));
+
+          for(unsigned int i = 0; i < n; ++i)
+          {
+               Pose pose = model.link(i)->pose();
+
+               std::string what = model.name() + " link " + std::to_string(i) + " configuration " + std::to_string(j);
+
+               failures += expect_near(what + " batch_forward_kinematics() position", linkPositions.block(3*i,j,3,1), pose.translation());
+
+               failures += expect_near(what + " batch_forward_kinematics() rotation",
+                                       Eigen::Map<const Eigen::Matrix3d>(linkRotations.col(j).segment(9*i,9).data()), pose.rotation());
+          }
+     }
+
+     return failures;
+}
+
+/**
+ * Computing the branches of a tree on separate threads in update_state() should give the same state as one thread.
+ */
+int
+check_parallel_kinematics(KinematicTree &model, KinematicTree &reference, const std::vector<std::string> &frameNames)
+{
+     int failures = 0;
+
+     unsigned int n = model.number_of_joints();
+
+     model.use_parallel_kinematics();
+
+     for(unsigned int k = 0; k < 3; ++k)
+     {
+          Eigen::VectorXd q = Eigen::VectorXd::Random(n);
+          Eigen::VectorXd qdot = Eigen::VectorXd::Random(n);
+
+          model.update_state(q, qdot);
+          reference.update_state(q, qdot);
+
+          for(const std::string &frameName : frameNames)
+          {
+               std::string what = model.name() + " " + frameName + " in parallel";
+
+               failures += expect_near(what + " frame_pose()", pose_matrix(model.frame_pose(frameName)), pose_matrix(reference.frame_pose(frameName)));
+
+               failures += expect_near(what + " jacobian()", model.jacobian(frameName), reference.jacobian(frameName));
+
+               failures += expect_near(what + " jacobian_derivative_product()",
+                                       model.jacobian_derivative_product(model.find_frame(frameName)),
+                                       reference.jacobian_derivative_product(reference.find_frame(frameName)));
+          }
+
+          failures += expect_near(model.name() + " in parallel joint_inertia_matrix()", model.joint_inertia_matrix(), reference.joint_inertia_matrix());
+     }
+
+     model.use_serial_kinematics();
+
+     return failures;
+}
+
+int main()
+{
+     int failures = 0;
+
+     KinematicTree serial(Test::write_serial_robot("kinematics_test_serial.urdf", 7));
+     KinematicTree branched(Test::write_branched_robot("kinematics_test_branched.urdf", 2, 3, 3));
+
+     failures += check_jacobian_derivative(serial, {"endpoint"});
+     failures += check_jacobian_derivative(branched, {"endpoint0", "endpoint1", "endpoint2"});
+
+     failures += check_cached_frame_poses(serial, {"endpoint"});
+     failures += check_cached_frame_poses(branched, {"endpoint0", "endpoint1", "endpoint2"});
+
+     for(KinematicTree *model : {&serial, &branched})
+     {
+          model->set_number_of_threads(2);                                                          // So that the batches are split between threads
+     }
+
+     failures += check_batch_kinematics(serial, {"endpoint"});
+     failures += check_batch_kinematics(branched, {"endpoint0", "endpoint1", "endpoint2"});
+
+     KinematicTree reference(Test::write_branched_robot("kinematics_test_reference.urdf", 2, 3, 3));
+
+     failures += check_parallel_kinematics(branched, reference, {"endpoint0", "endpoint1", "endpoint2"});
+
+     if(failures == 0) std::cout << "[INFO] All the kinematics agree.\n";
+
+     return failures;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file   QPSolverAllocationTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks that repeated solves of the same size do not allocate on the heap.
+ *
+ * This is compiled with EIGEN_RUNTIME_NO_MALLOC and assertions enabled,
+ * so Eigen aborts the test if memory is allocated where it is forbidden.
+ * workspace_allocations() only counts resizes, so it is checked as well.
+ */
+
+#include "ActiveSetSolver.h"
+#include "QPSolver.h"
+
+#include <iostream>
+
+int main()
+{
+     int failures = 0;
+
+     for(unsigned int n : {6, 7, 12})
+     {
+          unsigned int m = 3;                                                                       // Number of equality constraints
+
+          // A problem like the one in the controllers
+          Eigen::MatrixXd H = Eigen::MatrixXd::Identity(n,n);
+          Eigen::VectorXd f = Eigen::VectorXd::Zero(n);
+          Eigen::MatrixXd A = Eigen::MatrixXd::Zero(m,n);
+          Eigen::VectorXd y = Eigen::VectorXd::Zero(m);
+          Eigen::VectorXd xd = Eigen::VectorXd::Zero(n);
+          Eigen::VectorXd xMin = Eigen::VectorXd::Constant(n,-1.0);
+          Eigen::VectorXd xMax = Eigen::VectorXd::Constant(n, 1.0);
+          Eigen::MatrixXd B = Eigen::MatrixXd::Ones(1,n);
+          Eigen::VectorXd z = Eigen::VectorXd::Constant(1, 0.5);
+          Eigen::VectorXd x0 = Eigen::VectorXd::Zero(n);                                            // Strictly inside the constraints
+          Eigen::VectorXd x = Eigen::VectorXd::Zero(n);                                             // Solution of the problem without equality constraints
+          Eigen::VectorXd xLS = Eigen::VectorXd::Zero(n);                                           // Solution of the least squares problem
+          Eigen::VectorXd xDual = Eigen::VectorXd::Zero(n);                                         // Solution of the least squares problem with the dual method
+
+          for(bool warm : {false, true})
+          {
+               QPSolver<double> solver, leastSquaresSolver, dualSolver;                             // Separate, so the last solution is from the same problem
+
+               dualSolver.use_dual();
+
+               ActiveSetSolver<double> activeSetSolver;
+
+               if(warm)
+               {
+                    solver.use_warm_start();
+                    leastSquaresSolver.use_warm_start();
+               }
+
+               unsigned int allocations = 0, leastSquaresAllocations = 0, dualAllocations = 0;
+
+               for(unsigned int i = 0; i < 100; ++i)
+               {
+                    // Change the problem a little every call, like a control loop
+                    H.diagonal().setConstant(1.0 + 0.01*i);
+                    f.setConstant(-0.02*i);
+                    f(i % n) = 0.5;
+                    for(unsigned int j = 0; j < m; j++) A(j, (i + j) % n) = 1.0;
+                    y.setConstant(0.1);
+                    xd.setConstant(0.01*i);
+
+                    if(i == 1)                                                                      // The first call sizes the memory
+                    {
+                         allocations             = solver.workspace_allocations();
+                         leastSquaresAllocations = leastSquaresSolver.workspace_allocations();
+                         dualAllocations         = dualSolver.workspace_allocations();
+                    }
+
+                    if(i > 0) Eigen::internal::set_is_malloc_allowed(false);
+
+                    x   = solver.solve(H, f, xMin, xMax, B, z, warm ? x : x0);                      // Passing the last solution warm starts it
+                    xLS = leastSquaresSolver.constrained_least_squares(xd, H, A, y, xMin, xMax, B, z, warm ? xLS : x0);
+                    xDual = dualSolver.constrained_least_squares(xd, H, A, y, xMin, xMax, B, z, x0);
+                    activeSetSolver.solve(H, f, A, y, xMin, xMax, B, z);
+
+                    Eigen::internal::set_is_malloc_allowed(true);
+
+                    A.setZero();
+               }
+
+               if(solver.workspace_allocations() != allocations
+               or leastSquaresSolver.workspace_allocations() != leastSquaresAllocations
+               or dualSolver.workspace_allocations() != dualAllocations)
+               {
+                    std::cerr << "[FAILED] " << n << " variables: the workspace was resized after the first call.\n";
+
+                    failures++;
+               }
+          }
+
+          std::cout << "[INFO] " << n << " variables: done.\n";
+     }
+
+     return failures;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file   SharedModelTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks that one model can be shared by several threads, each with its own KinematicTreeData.
+ */
+
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <atomic>                                                                                   // std::atomic
+#include <iostream>
+#include <memory>                                                                                   // std::shared_ptr
+
+using namespace RobotLibrary;
+
+int main()
+{
+     std::shared_ptr<const KinematicTree> model = std::make_shared<KinematicTree>(Test::write_branched_robot("shared_model_test.urdf", 2, 3, 3));
+     
+     KinematicTree reference(Test::write_branched_robot("shared_model_reference.urdf", 2, 3, 3));   // Computes the expected values with its own state
+     
+     unsigned int n = model->number_of_joints();
+     
+     std::vector<Eigen::VectorXd> jointPosition, jointVelocity, jointAcceleration, expectedTorque, expectedGravity;
+     
+     for(unsigned int k = 0; k < 4; ++k)
+     {
+          jointPosition.push_back(Eigen::VectorXd::Random(n));
+          jointVelocity.push_back(Eigen::VectorXd::Random(n));
+          jointAcceleration.push_back(Eigen::VectorXd::Random(n));
+          
+          reference.update_state(jointPosition[k], jointVelocity[k]);
+          
+          expectedTorque.push_back(reference.joint_inertia_matrix()*jointAcceleration[k]
+                                 + reference.joint_coriolis_vector()
+                                 + reference.joint_damping_vector()
+                                 + reference.joint_gravity_vector());
+          
+          expectedGravity.push_back(reference.joint_gravity_vector());
+     }
+     
+     std::atomic<int> failures{0};
+     
+     std::vector<std::thread> threads;
+     
+     for(unsigned int k = 0; k < 4; ++k)
+     {
+          threads.emplace_back([&, k]
+          {
+               KinematicTreeData data = model->make_data();
+               
+               for(unsigned int i = 0; i < 100; ++i)
+               {
+                    model->update_state(jointPosition[k], jointVelocity[k], data);
+                    
+                    if((model->inverse_dynamics(jointAcceleration[k], data) - expectedTorque[k]).norm() > 1e-9) failures++;
+                    
+                    if((model->gravity_torques(jointPosition[k], data) - expectedGravity[k]).norm() > 1e-9) failures++;
+               }
+               
+               // The base state of this thread is used, not the model's
+               data.gravity.setZero();
+               
+               if((model->inverse_dynamics(jointAcceleration[k], data) - (expectedTorque[k] - expectedGravity[k])).norm() > 1e-9) failures++;
+               
+               data.baseAcceleration.head(3) << 0, 0, 9.81;                                         // Accelerating upward is the same as gravity
+               
+               if((model->inverse_dynamics(jointAcceleration[k], data) - expectedTorque[k]).norm() > 1e-9) failures++;
+          });
+     }
+     
+     for(std::thread &thread : threads) thread.join();
+     
+     if(failures > 0) std::cerr << "[FAILED] " << failures << " results did not match the model's own.\n";
+     
+     return failures;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file   WarmStartControlTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks that the kinematic controller warm starts its QP solver when a joint speed limit is active.
+ *
+ * A 6 joint arm is held still and the commanded endpoint speed is too fast, so the solution sits
+ * against the speed limits every call. A warm started controller should resume from its last
+ * solution and converge in a few steps, where a cold started one runs from the start again.
+ */
+
+#include "SerialKinematicControl.h"
+#include "TestModels.h"
+
+#include <iostream>
+
+using namespace RobotLibrary;
+
+int main()
+{
+     int failures = 0;
+
+     const unsigned int n = 6;                                                                      // Solved as a QP, with the speed limits as bounds
+
+     const unsigned int numCalls = 50;
+
+     KinematicTree model(Test::write_serial_robot("warm_start_control_test.urdf", n));
+
+     model.update_state(Eigen::VectorXd::Constant(n, 0.5), Eigen::VectorXd::Zero(n));
+
+     SerialKinematicControl warmController(&model, "endpoint", 500.0);
+     SerialKinematicControl coldController(&model, "endpoint", 500.0);
+
+     for(SerialKinematicControl *controller : {&warmController, &coldController})
+     {
+          // The defaults stop after a step or two on this problem,
+          // so tighten them to compare the two solutions
+          controller->set_barrier_scalar(100.0);
+          controller->set_barrier_reduction_rate(0.5);
+          controller->set_tolerance(1e-06);
+          controller->set_max_steps(100);
+     }
+
+     warmController.use_warm_start();
+
+     if(not warmController.warm_start_enabled() or coldController.warm_start_enabled())
+     {
+          std::cerr << "[FAILED] warm_start_enabled() does not match use_warm_start().\n";
+
+          failures++;
+     }
+
+     unsigned int numWarmStarts = 0, warmSteps = 0, coldSteps = 0;
+
+     bool boundActive = true;
+
+     for(unsigned int i = 0; i < numCalls; ++i)
+     {
+          Eigen::Vector<double,6> endpointMotion;
+          endpointMotion << 5.0, -5.0, 5.0, 0.0, 0.0, 0.1 + 0.001*i;                                // Changes a little every call, like a control loop
+
+          Eigen::VectorXd warmVelocity = warmController.resolve_endpoint_motion(endpointMotion);
+          Eigen::VectorXd coldVelocity = coldController.resolve_endpoint_motion(endpointMotion);
+
+          if(warmVelocity.cwiseAbs().maxCoeff() < 1.99) boundActive = false;                        // The speed limit is 2 rad/s
+
+          if((warmVelocity - coldVelocity).norm() > 1e-03)
+          {
+               std::cerr << "[FAILED] Call " << i << ": the warm start changed the solution by "
+                         << (warmVelocity - coldVelocity).norm() << ".\n";
+
+               failures++;
+          }
+
+          if(coldController.was_warm_started())
+          {
+               std::cerr << "[FAILED] Call " << i << ": the cold controller was warm started.\n";
+
+               failures++;
+          }
+
+          if(i == 0) continue;                                                                      // Nothing to warm start from
+
+          if(warmController.was_warm_started()) numWarmStarts++;
+
+          warmSteps += warmController.num_steps();
+          coldSteps += coldController.num_steps();
+     }
+
+     if(not boundActive)
+     {
+          std::cerr << "[FAILED] No joint was at its speed limit, so the test does not check anything.\n";
+
+          failures++;
+     }
+
+     // It starts cold if the last solution is not strictly inside the new bounds, which may happen now and then
+     if(numWarmStarts < 0.9*(numCalls - 1))
+     {
+          std::cerr << "[FAILED] Only " << numWarmStarts << " of " << numCalls - 1 << " calls were warm started.\n";
+
+          failures++;
+     }
+
+     if(warmSteps > 3*(numCalls - 1) or 4*warmSteps > coldSteps)
+     {
+          std::cerr << "[FAILED] The warm start took " << warmSteps << " steps and the cold start " << coldSteps << ".\n";
+
+          failures++;
+     }
+
+     std::cout << "[INFO] " << numWarmStarts << " of " << numCalls - 1 << " calls were warm started. "
+               << "They took " << warmSteps << " steps, and " << coldSteps << " steps cold.\n";
+
+     return failures;
+}
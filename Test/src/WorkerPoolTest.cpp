@@ -0,0 +1,52 @@
+/**
+ * @file   WorkerPoolTest.cpp
+ * @author Jon Woolfrey
+ * @date   October 2026
+ * @brief  Checks that the worker pool can be replaced while a batch is running on another thread.
+ */
+
+#include "KinematicTree.h"
+#include "TestModels.h"
+
+#include <atomic>                                                                                   // std::atomic
+#include <iostream>
+
+using namespace RobotLibrary;
+
+int main()
+{
+     KinematicTree model(Test::write_serial_robot("worker_pool_test.urdf", 7));
+     
+     ReferenceFrame *endpoint = model.find_frame("endpoint");
+     
+     Eigen::MatrixXd jointPositions = 0.5*Eigen::MatrixXd::Random(7,64);
+     
+     std::vector<Pose> expected = model.batch_frame_pose(endpoint, jointPositions);
+     
+     std::atomic<bool> finished{false};
+     
+     int failures = 0;
+     
+     std::thread batches([&]
+     {
+          for(unsigned int i = 0; i < 200; ++i)
+          {
+               std::vector<Pose> framePose = model.batch_frame_pose(endpoint, jointPositions);
+               
+               for(unsigned int j = 0; j < framePose.size(); ++j)
+               {
+                    if((framePose[j].translation() - expected[j].translation()).norm() > 1e-12) failures++;
+               }
+          }
+          
+          finished = true;
+     });
+     
+     for(unsigned int k = 0; not finished; ++k) model.set_number_of_threads(1 + k % 4);           // Replaces the pool under the batches
+     
+     batches.join();
+     
+     if(failures > 0) std::cerr << "[FAILED] " << failures << " frame poses did not match.\n";
+     
+     return failures;
+}